@@ -159,21 +159,26 @@ void fileDataGet(Thread *thread) {
     long length = ftell(file);
     state = fseek(file, 0, SEEK_SET);
 
-    auto bytesObject = thread->retain(Emojicode::newArray(length));
-    fread(bytesObject->val<char>(), 1, length, file);
-    if (ferror(file)) {
+    auto bytesObject = thread->retain(Emojicode::newPinnedBuffer(length));
+    char *bytes = Emojicode::pinnedBufferBytes(bytesObject.unretainedPointer());
+    bool failed;
+    {
+        Emojicode::BlockingRegion region;
+        fread(bytes, 1, length, file);
+        failed = ferror(file);
         fclose(file);
+    }
+    if (failed) {
         thread->release(1);
         thread->returnNothingnessFromFunction();
         return;
     }
-    fclose(file);
 
     Emojicode::Object *obj = Emojicode::newObject(Emojicode::CL_DATA);
     Data *data = obj->val<Data>();
     data->length = length;
     data->bytesObject = bytesObject.unretainedPointer();
-    data->bytes = bytesObject->val<char>();
+    data->bytes = bytes;
 
     thread->release(1);
     thread->returnOEValueFromFunction(obj);
@@ -232,11 +237,17 @@ void fileReadData(Thread *thread) {
     FILE *f = file(thread->thisObject());
     Emojicode::EmojicodeInteger n = thread->variable(0).raw;
 
-    auto bytesObject = thread->retain(Emojicode::newArray(n));
-    fread(bytesObject->val<char>(), 1, n, f);
-    if (ferror(f) != 0) {
-        thread->returnErrorFromFunction(errnoToError());
+    auto bytesObject = thread->retain(Emojicode::newPinnedBuffer(n));
+    char *bytes = Emojicode::pinnedBufferBytes(bytesObject.unretainedPointer());
+    bool failed;
+    {
+        Emojicode::BlockingRegion region;
+        fread(bytes, 1, n, f);
+        failed = ferror(f) != 0;
+    }
+    if (failed) {
         thread->release(1);
+        thread->returnErrorFromFunction(errnoToError());
         return;
     }
 
@@ -244,7 +255,7 @@ void fileReadData(Thread *thread) {
     Data *data = obj->val<Data>();
     data->length = n;
     data->bytesObject = bytesObject.unretainedPointer();
-    data->bytes = bytesObject->val<char>();
+    data->bytes = bytes;
 
     thread->returnOEValueFromFunction(obj);
     thread->release(1);
@@ -7,6 +7,7 @@
 //
 
 #include "../../EmojicodeReal-TimeEngine/EmojicodeAPI.hpp"
+#include "../../EmojicodeReal-TimeEngine/Fiber.hpp"
 #include "../../EmojicodeReal-TimeEngine/Thread.hpp"
 #include "../../EmojicodeReal-TimeEngine/String.h"
 #include "../../EmojicodeReal-TimeEngine/standard.h"
@@ -16,6 +17,8 @@
 #include <string.h>
 #include <unistd.h>
 #include <cerrno>
+#include <string>
+#include <vector>
 
 using Emojicode::Thread;
 using Emojicode::Value;
@@ -63,7 +66,12 @@ void serverAccept(Thread *thread) {
     int listenerDescriptor = *thread->thisObject()->val<int>();
     struct sockaddr_storage clientAddress;
     unsigned int addressSize = sizeof(clientAddress);
-    int connectionAddress = accept(listenerDescriptor, (struct sockaddr *)&clientAddress, &addressSize);
+    int connectionAddress;
+    Emojicode::Fibers::waitForDescriptor(thread, listenerDescriptor, false);
+    {
+        Emojicode::BlockingRegion region;
+        connectionAddress = accept(listenerDescriptor, (struct sockaddr *)&clientAddress, &addressSize);
+    }
 
     if (connectionAddress == -1) {
         thread->returnNothingnessFromFunction();
@@ -77,8 +85,21 @@ void serverAccept(Thread *thread) {
 
 void socketSendData(Thread *thread) {
     int connectionAddress = *thread->thisObject()->val<int>();
+    Emojicode::Fibers::waitForDescriptor(thread, connectionAddress, true);
     Data *data = thread->variable(0).object->val<Data>();
-    thread->returnFromFunction(send(connectionAddress, data->bytes, data->length, 0) == -1);
+    ssize_t sent;
+    if (data->pinned()) {
+        const char *bytes = data->bytes;
+        size_t length = data->length;
+        Emojicode::BlockingRegion region;
+        sent = send(connectionAddress, bytes, length, 0);
+    }
+    else {
+        std::vector<char> bytes(data->bytes, data->bytes + data->length);
+        Emojicode::BlockingRegion region;
+        sent = send(connectionAddress, bytes.data(), bytes.size(), 0);
+    }
+    thread->returnFromFunction(sent == -1);
 }
 
 void socketClose(Thread *thread) {
@@ -90,9 +111,15 @@ void socketClose(Thread *thread) {
 void socketReadBytes(Thread *thread) {
     int connectionAddress = *thread->thisObject()->val<int>();
     Emojicode::EmojicodeInteger n = thread->variable(0).raw;
-
-    auto bytesObject = thread->retain(Emojicode::newArray(n));
-    size_t read = recv(connectionAddress, bytesObject->val<char>(), n, 0);
+    Emojicode::Fibers::waitForDescriptor(thread, connectionAddress, false);
+
+    auto bytesObject = thread->retain(Emojicode::newPinnedBuffer(n));
+    char *bytes = Emojicode::pinnedBufferBytes(bytesObject.unretainedPointer());
+    ssize_t read;
+    {
+        Emojicode::BlockingRegion region;
+        read = recv(connectionAddress, bytes, n, 0);
+    }
 
     if (read < 1) {
         thread->release(1);
@@ -104,27 +131,37 @@ void socketReadBytes(Thread *thread) {
     Data *data = obj->val<Data>();
     data->length = read;
     data->bytesObject = bytesObject.unretainedPointer();
-    data->bytes = data->bytesObject->val<char>();
+    data->bytes = bytes;
 
     thread->release(1);
     thread->returnOEValueFromFunction(obj);
 }
 
 void socketInitWithHost(Thread *thread) {
-    struct hostent *server = gethostbyname(Emojicode::stringToCString(thread->variable(0).object));
-    if (!server) {
-        thread->returnErrorFromFunction(errnoToError());
-        return;
+    std::string host = Emojicode::stringToCString(thread->variable(0).object);
+    auto port = htons(thread->variable(1).raw);
+    int socketDescriptor;
+    bool failed;
+    {
+        Emojicode::BlockingRegion region;
+        struct hostent *server = gethostbyname(host.c_str());
+        if (!server) {
+            failed = true;
+        }
+        else {
+            struct sockaddr_in address;
+            memset(&address, 0, sizeof(address));
+            memcpy(&address.sin_addr.s_addr, server->h_addr_list[0], server->h_length);
+            address.sin_family = PF_INET;
+            address.sin_port = port;
+
+            socketDescriptor = socket(AF_INET, SOCK_STREAM, 0);
+            failed = socketDescriptor == -1 ||
+                     connect(socketDescriptor, (struct sockaddr *) &address, sizeof(address)) == -1;
+        }
     }
 
-    struct sockaddr_in address;
-    memset(&address, 0, sizeof(address));
-    memcpy(&address.sin_addr.s_addr, server->h_addr_list[0], server->h_length);
-    address.sin_family = PF_INET;
-    address.sin_port = htons(thread->variable(1).raw);
-
-    int socketDescriptor = socket(AF_INET, SOCK_STREAM, 0);
-    if (socketDescriptor == -1 || connect(socketDescriptor, (struct sockaddr *) &address, sizeof(address)) == -1) {
+    if (failed) {
         thread->returnErrorFromFunction(errnoToError());
         return;
     }
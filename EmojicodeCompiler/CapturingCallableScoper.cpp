@@ -21,7 +21,9 @@ ResolvedVariable CapturingCallableScoper::getVariable(const EmojicodeString &nam
         auto &variable = pair.variable;
         auto &captureVariable = topmostLocalScope().setLocalVariableWithID(variable.name(), variable.type(), true,
                                                                            captureId_, variable.position());
-        captureVariable.initialized_ = maxInitializationLevel();
+        // The topmost local scope is one level below maxInitializationLevel(). Matching its level ensures the
+        // variable is recorded for the garbage collector when the scope is popped.
+        captureVariable.initialized_ = maxInitializationLevel() - 1;
         captureVariable.initializationPosition_ = 0;
         captures_.push_back(VariableCapture(variable.id(), variable.type(), captureId_));
         captureSize_ += variable.type().size();
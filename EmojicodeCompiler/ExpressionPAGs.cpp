@@ -103,16 +103,19 @@ Type pagDictionaryLiteral(const Token &token, const TypeExpectation &expectation
     auto &scope = functionPag.scoper().pushScope();
 
     auto variablePlaceholder = functionPag.writer().writeInstructionPlaceholder();
+    auto countPlaceholder = functionPag.writer().writeInstructionPlaceholder();
     auto placeholder = functionPag.writer().writeInstructionsCountPlaceholderCoin();
 
     auto initCount = functionPag.writer().count();
 
     Type type = Type(CL_DICTIONARY, false);
+    EmojicodeInstruction count = 0;
     if (expectation.type() == TypeContent::Class && expectation.eclass() == CL_DICTIONARY) {
         auto elementType = Type(TypeContent::GenericVariable, false, 0, expectation.eclass()).resolveOn(expectation);
         while (functionPag.stream().nextTokenIsEverythingBut(E_AUBERGINE)) {
             functionPag.parseTypeSafeExpr(Type(CL_STRING, false));
             functionPag.parseTypeSafeExpr(elementType);
+            count++;
         }
         functionPag.stream().consumeToken(TokenType::Identifier);
         type.setGenericArgument(0, elementType);
@@ -125,6 +128,7 @@ Type pagDictionaryLiteral(const Token &token, const TypeExpectation &expectation
         while (functionPag.stream().nextTokenIsEverythingBut(E_AUBERGINE)) {
             functionPag.parseTypeSafeExpr(Type(CL_STRING, false));
             ct.addType(functionPag.parseExpr(TypeExpectation(false, true, false)), functionPag.typeContext());
+            count++;
         }
         functionPag.stream().consumeToken(TokenType::Identifier);
         type.setGenericArgument(0, ct.getCommonType(token.position()));
@@ -133,6 +137,7 @@ Type pagDictionaryLiteral(const Token &token, const TypeExpectation &expectation
         variablePlaceholder.write(var.id());
     }
 
+    countPlaceholder.write(count);
     placeholder.write();
     functionPag.popScope();
     return type;
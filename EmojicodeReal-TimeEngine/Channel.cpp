@@ -0,0 +1,199 @@
+//
+//  Channel.cpp
+//  Emojicode
+//
+
+#include "Channel.h"
+#include "List.h"
+#include "Memory.hpp"
+#include "Thread.hpp"
+#include <algorithm>
+#include <new>
+
+namespace Emojicode {
+
+// Every thread acquires the mutex of a channel with lockBlocking(). The heap pointers must therefore be read again
+// after it, while the ChannelState is never moved.
+
+ChannelState* channelState(Object *channel) {
+    return channel->val<Channel>()->channelState();
+}
+
+void notifyWaiters(ChannelState *state) {
+    for (auto waiter : state->waiters) {
+        waiter->signal();
+    }
+}
+
+/// Moves the first item of @c channel to @c destination. The mutex of the channel must be locked.
+bool tryReceive(Object *channel, ChannelState *state, Value *destination) {
+    if (state->count == 0) {
+        return false;
+    }
+    Box *item = channel->val<Channel>()->items() + state->head;
+    item->copyTo(destination);
+    item->makeNothingness();
+    state->head = (state->head + 1) % state->slots;
+    state->count--;
+    state->received++;
+    state->notFull.notifyOne();
+    if (!state->buffered) {
+        state->delivered.notifyAll();
+    }
+    return true;
+}
+
+void channelMark(Object *self) {
+    auto *channel = self->val<Channel>();
+    if (channel->state == nullptr) {
+        return;
+    }
+    mark(&channel->state);
+    if (channel->buffer == nullptr) {
+        return;
+    }
+    mark(&channel->buffer);
+    // Free slots contain Nothingness, so all slots can be visited without locking the mutex. slots never changes.
+    for (size_t i = 0; i < channel->channelState()->slots; i++) {
+        Box &item = channel->items()[i];
+        if (item.type.raw == T_OBJECT || (item.type.raw & REMOTE_MASK) != 0) {
+            mark(&item.value1.object);
+        }
+    }
+}
+
+void initChannel(Thread *thread) {
+    EmojicodeInteger capacity = std::max<EmojicodeInteger>(thread->variable(0).raw, 0);
+    auto *channel = thread->thisObject()->val<Channel>();
+    channel->state = nullptr;
+    channel->buffer = nullptr;
+
+    Object *state = newPinnedBuffer(sizeof(ChannelState), [](char *bytes) {
+        reinterpret_cast<ChannelState *>(bytes)->~ChannelState();
+    });
+    auto *channelState = new (pinnedBufferBytes(state)) ChannelState(static_cast<size_t>(capacity));
+    thread->thisObject()->val<Channel>()->state = state;
+
+    Object *buffer = newArray(sizeCalculationWithOverflowProtection(channelState->slots, sizeof(Box)));
+    channel = thread->thisObject()->val<Channel>();
+    channel->buffer = buffer;
+    for (size_t i = 0; i < channelState->slots; i++) {
+        channel->items()[i].makeNothingness();
+    }
+    thread->returnFromFunction(thread->thisContext());
+}
+
+void channelSend(Thread *thread) {
+    ChannelState *state = channelState(thread->thisObject());
+    std::unique_lock<std::mutex> lock(state->mutex, std::defer_lock);
+    lockBlocking(lock);
+    while (state->count == state->slots && !state->closed) {
+        waitOnQueue(thread, lock, state->notFull);
+    }
+    if (state->closed) {
+        thread->returnFromFunction(false);
+        return;
+    }
+
+    auto *channel = thread->thisObject()->val<Channel>();
+    channel->items()[(state->head + state->count) % state->slots].copy(thread->variableDestination(0));
+    state->count++;
+    size_t ticket = state->sent++;
+    state->notEmpty.notifyOne();
+    notifyWaiters(state);
+
+    while (!state->buffered && state->received <= ticket && !state->closed) {
+        waitOnQueue(thread, lock, state->delivered);
+    }
+    thread->returnFromFunction(true);
+}
+
+void channelReceive(Thread *thread) {
+    ChannelState *state = channelState(thread->thisObject());
+    std::unique_lock<std::mutex> lock(state->mutex, std::defer_lock);
+    lockBlocking(lock);
+    while (state->count == 0 && !state->closed) {
+        waitOnQueue(thread, lock, state->notEmpty);
+    }
+    if (tryReceive(thread->thisObject(), state, thread->currentStackFrame()->destination)) {
+        thread->returnFromFunction();
+    }
+    else {
+        thread->returnNothingnessFromFunction();
+    }
+}
+
+void channelClose(Thread *thread) {
+    ChannelState *state = channelState(thread->thisObject());
+    std::unique_lock<std::mutex> lock(state->mutex, std::defer_lock);
+    lockBlocking(lock);
+    state->closed = true;
+    state->notEmpty.notifyAll();
+    state->notFull.notifyAll();
+    state->delivered.notifyAll();
+    notifyWaiters(state);
+    thread->returnFromFunction();
+}
+
+Object* selectChannel(Thread *thread, size_t index) {
+    return thread->variable(0).object->val<List>()->elements()[index].value1.object;
+}
+
+void channelSelect(Thread *thread) {
+    Waiter waiter;
+    waiter.fiber = thread->fiber();
+    std::vector<ChannelState *> states;
+    while (true) {
+        states.clear();
+        bool open = false;
+        for (size_t i = 0; i < thread->variable(0).object->val<List>()->count; i++) {
+            ChannelState *state = channelState(selectChannel(thread, i));
+            std::unique_lock<std::mutex> lock(state->mutex, std::defer_lock);
+            lockBlocking(lock);
+            if (tryReceive(selectChannel(thread, i), state, thread->currentStackFrame()->destination)) {
+                thread->returnFromFunction();
+                return;
+            }
+            open = open || !state->closed;
+            states.push_back(state);
+        }
+        if (!open) {
+            thread->returnNothingnessFromFunction();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(waiter.mutex);
+            waiter.signaled = false;
+        }
+        for (auto state : states) {
+            std::unique_lock<std::mutex> lock(state->mutex, std::defer_lock);
+            lockBlocking(lock);
+            if (state->count > 0 || state->closed) {
+                // Another channel registered before may already signal the waiter.
+                std::lock_guard<std::mutex> waiterLock(waiter.mutex);
+                waiter.signaled = true;
+            }
+            state->waiters.push_back(&waiter);
+        }
+        if (waiter.fiber != nullptr) {
+            std::unique_lock<std::mutex> lock(waiter.mutex);
+            if (!waiter.signaled) {
+                lock.unlock();
+                Fibers::park(thread);
+            }
+        }
+        else {
+            BlockingRegion region;
+            std::unique_lock<std::mutex> lock(waiter.mutex);
+            waiter.condition.wait(lock, [&waiter] { return waiter.signaled; });
+        }
+        for (auto state : states) {
+            std::unique_lock<std::mutex> lock(state->mutex, std::defer_lock);
+            lockBlocking(lock);
+            state->waiters.erase(std::find(state->waiters.begin(), state->waiters.end(), &waiter));
+        }
+    }
+}
+
+}
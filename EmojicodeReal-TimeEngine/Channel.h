@@ -0,0 +1,60 @@
+//
+//  Channel.h
+//  Emojicode
+//
+
+#ifndef Channel_h
+#define Channel_h
+
+#include "EmojicodeAPI.hpp"
+#include "WaitQueue.hpp"
+#include <mutex>
+#include <vector>
+
+namespace Emojicode {
+
+/// The synchronization state of a channel, which is kept in a pinned buffer so that threads can wait on it inside a
+/// BlockingRegion. Every member is guarded by @c mutex.
+struct ChannelState {
+    explicit ChannelState(size_t capacity) : buffered(capacity > 0), slots(capacity > 0 ? capacity : 1) {}
+
+    std::mutex mutex;
+    WaitQueue notEmpty;
+    /// Notified when a slot becomes free.
+    WaitQueue notFull;
+    /// Notified when an item of an unbuffered channel was received.
+    WaitQueue delivered;
+    /// Whether send returns before the item was received.
+    bool buffered;
+    size_t slots;
+    size_t head = 0;
+    size_t count = 0;
+    /// The number of items sent and received so far.
+    size_t sent = 0;
+    size_t received = 0;
+    bool closed = false;
+    /// The selects waiting on this channel.
+    std::vector<Waiter *> waiters;
+};
+
+struct Channel {
+    /// A pinned buffer that contains the ChannelState.
+    Object *state;
+    /// An array of @c ChannelState::slots boxes used as ring buffer.
+    Object *buffer;
+
+    ChannelState* channelState() { return reinterpret_cast<ChannelState *>(pinnedBufferBytes(state)); }
+    Box* items() { return buffer->val<Box>(); }
+};
+
+void channelMark(Object *self);
+
+void initChannel(Thread *thread);
+void channelSend(Thread *thread);
+void channelReceive(Thread *thread);
+void channelClose(Thread *thread);
+void channelSelect(Thread *thread);
+
+}
+
+#endif /* Channel_h */
@@ -18,3 +18,22 @@ bool Class::inheritsFrom(Class *from) const {
     }
     return false;
 }
+
+void Class::prepareReferenceBitmap() {
+    referenceBitmap = 0;
+    conditionalRecords = new ObjectVariableRecord[instanceVariableRecordsCount];
+    conditionalRecordsCount = 0;
+
+    // Records following a ConditionalSkip record might be skipped and must therefore remain records.
+    bool skipSeen = false;
+    for (unsigned int i = 0; i < instanceVariableRecordsCount; i++) {
+        auto &record = instanceVariableRecords[i];
+        skipSeen = skipSeen || record.type == ObjectVariableType::ConditionalSkip;
+        if (!skipSeen && record.type == ObjectVariableType::Simple && record.variableIndex < 64) {
+            referenceBitmap |= UINT64_C(1) << record.variableIndex;
+        }
+        else {
+            conditionalRecords[conditionalRecordsCount++] = record;
+        }
+    }
+}
@@ -15,10 +15,14 @@ namespace Emojicode {
 
 struct Class {
     Class() {}
-    explicit Class(void (*mark)(Object *)) : instanceVariableRecords(nullptr), mark(mark), size(0), valueSize(0) {}
+    explicit Class(void (*mark)(Object *)) : instanceVariableRecords(nullptr), instanceVariableRecordsCount(0),
+        referenceBitmap(0), conditionalRecords(nullptr), conditionalRecordsCount(0), mark(mark), size(0),
+        valueSize(0) {}
 
     /** Returns true if @c a inherits from class @c from */
     bool inheritsFrom(Class *from) const;
+    /// Derives @c referenceBitmap and @c conditionalRecords from @c instanceVariableRecords.
+    void prepareReferenceBitmap();
 
     Function **methodsVtable;
     Function **initializersVtable;
@@ -30,6 +34,13 @@ struct Class {
 
     ObjectVariableRecord *instanceVariableRecords;
     unsigned int instanceVariableRecordsCount;
+    /// Bit @c i is set if instance variable @c i is an object reference that must always be marked. Together with
+    /// @c conditionalRecords this describes the same references as @c instanceVariableRecords, but allows the garbage
+    /// collector to trace most of them without evaluating records.
+    uint64_t referenceBitmap;
+    /// The records that are not represented in @c referenceBitmap.
+    ObjectVariableRecord *conditionalRecords;
+    unsigned int conditionalRecordsCount;
 
     /** Marker FunctionPointer for GC */
     void (*mark)(Object *self);
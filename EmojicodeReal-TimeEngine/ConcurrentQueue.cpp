@@ -0,0 +1,106 @@
+//
+//  ConcurrentQueue.cpp
+//  Emojicode
+//
+
+#include "ConcurrentQueue.h"
+#include "Memory.hpp"
+#include "Thread.hpp"
+
+namespace Emojicode {
+
+void concurrentQueueMark(Object *self) {
+    auto *queue = self->val<ConcurrentQueue>();
+    if (queue->cells == nullptr) {
+        return;
+    }
+    mark(&queue->cells);
+    for (size_t i = 0; i <= queue->mask; i++) {
+        ConcurrentQueueCell *cell = queue->cellAt(i);
+        if (cell->object != nullptr) {
+            mark(&cell->object);
+        }
+    }
+}
+
+void initConcurrentQueue(Thread *thread) {
+    EmojicodeInteger requested = thread->variable(0).raw;
+    size_t capacity = 2;
+    while (static_cast<EmojicodeInteger>(capacity) < requested) {
+        capacity <<= 1;
+    }
+
+    auto *queue = thread->thisObject()->val<ConcurrentQueue>();
+    queue->cells = nullptr;
+    Object *cells = newArray(sizeCalculationWithOverflowProtection(capacity, sizeof(ConcurrentQueueCell)));
+    queue = thread->thisObject()->val<ConcurrentQueue>();
+    queue->cells = cells;
+    queue->mask = capacity - 1;
+    queue->enqueuePosition.store(0, std::memory_order_relaxed);
+    queue->dequeuePosition.store(0, std::memory_order_relaxed);
+    for (size_t i = 0; i < capacity; i++) {
+        queue->cellAt(i)->sequence.store(i, std::memory_order_relaxed);
+        queue->cellAt(i)->object = nullptr;
+    }
+    thread->returnFromFunction(thread->thisContext());
+}
+
+void concurrentQueueEnqueue(Thread *thread) {
+    auto *queue = thread->thisObject()->val<ConcurrentQueue>();
+    Object *object = reinterpret_cast<Box *>(thread->variableDestination(0))->value1.object;
+
+    size_t position = queue->enqueuePosition.load(std::memory_order_relaxed);
+    ConcurrentQueueCell *cell;
+    while (true) {
+        cell = queue->cellAt(position);
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+        if (difference == 0) {
+            if (queue->enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (difference < 0) {
+            thread->returnFromFunction(false);
+            return;
+        }
+        else {
+            position = queue->enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+    cell->object = object;
+    cell->sequence.store(position + 1, std::memory_order_release);
+    thread->returnFromFunction(true);
+}
+
+void concurrentQueueDequeue(Thread *thread) {
+    auto *queue = thread->thisObject()->val<ConcurrentQueue>();
+
+    size_t position = queue->dequeuePosition.load(std::memory_order_relaxed);
+    ConcurrentQueueCell *cell;
+    while (true) {
+        cell = queue->cellAt(position);
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+        if (difference == 0) {
+            if (queue->dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (difference < 0) {
+            thread->returnNothingnessFromFunction();
+            return;
+        }
+        else {
+            position = queue->dequeuePosition.load(std::memory_order_relaxed);
+        }
+    }
+    Object *object = cell->object;
+    cell->object = nullptr;
+    cell->sequence.store(position + queue->mask + 1, std::memory_order_release);
+
+    Box(T_OBJECT, object).copyTo(thread->currentStackFrame()->destination);
+    thread->returnFromFunction();
+}
+
+}
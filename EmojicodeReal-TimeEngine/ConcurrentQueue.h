@@ -0,0 +1,45 @@
+//
+//  ConcurrentQueue.h
+//  Emojicode
+//
+
+#ifndef ConcurrentQueue_h
+#define ConcurrentQueue_h
+
+#include "EmojicodeAPI.hpp"
+#include <atomic>
+
+namespace Emojicode {
+
+struct ConcurrentQueueCell {
+    /// Tells producers and consumers which lap around the queue this cell is ready for.
+    std::atomic_size_t sequence;
+    /// The enqueued object or @c nullptr if the cell is empty.
+    Object *object;
+};
+
+/// A bounded lock-free multi-producer multi-consumer queue of object references.
+///
+/// All state lives in the heap and may therefore be moved by the garbage collector. This is safe as no thread can be
+/// paused in the middle of an operation.
+struct ConcurrentQueue {
+    /// The array of ConcurrentQueueCell. Its size is a power of two.
+    Object *cells;
+    size_t mask;
+    std::atomic_size_t enqueuePosition;
+    /// Keeps the positions, which are written by producers and consumers respectively, on separate cache lines.
+    char padding[64];
+    std::atomic_size_t dequeuePosition;
+
+    ConcurrentQueueCell* cellAt(size_t position) { return cells->val<ConcurrentQueueCell>() + (position & mask); }
+};
+
+void concurrentQueueMark(Object *self);
+
+void initConcurrentQueue(Thread *thread);
+void concurrentQueueEnqueue(Thread *thread);
+void concurrentQueueDequeue(Thread *thread);
+
+}
+
+#endif /* ConcurrentQueue_h */
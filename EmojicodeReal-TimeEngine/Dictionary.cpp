@@ -10,368 +10,520 @@
 #include "EmojicodeAPI.hpp"
 #include "String.h"
 #include "Thread.hpp"
+#include <cstdint>
+#include <cstring>
 
 namespace Emojicode {
 
-#define FNV_PRIME_64 1099511628211
-#define FNV_OFFSET_64 14695981039346656037U
-EmojicodeDictionaryHash fnv64(const void *input, size_t length) {
-    auto k = reinterpret_cast<const char*>(input);
-    EmojicodeDictionaryHash hash = FNV_OFFSET_64;
-    for (size_t i = 0; i < length; i++) {
-        hash = hash ^ k[i];
-        hash = hash * FNV_PRIME_64;
+// MARK: Keys
+
+// The following structures tell the table how the keys of a kind of dictionary are read from the arguments of a method,
+// hashed, compared and returned as list items.
+
+/// The 🔡 keys of 🍯.
+struct StringKeys {
+    static const EmojicodeInteger type = T_OBJECT;
+    static Value argument(Thread *thread) { return thread->variable(0).object; }
+    static EmojicodeDictionaryHash hash(Value key) { return stringHash(key.object->val<String>()); }
+    static bool equal(Value a, Value b) { return stringEqual(a.object->val<String>(), b.object->val<String>()); }
+};
+
+/// The 🚂 keys of 📒, which are stored unboxed.
+struct IntegerKeys {
+    static const EmojicodeInteger type = T_INTEGER;
+    static Value argument(Thread *thread) { return thread->variable(0).raw; }
+    /// Spreads the bits of the integer, so that consecutive integers differ in the control byte and the group.
+    static EmojicodeDictionaryHash hash(Value key) {
+        EmojicodeDictionaryHash hash = static_cast<EmojicodeDictionaryHash>(key.raw) * 0x9e3779b97f4a7c15ULL;
+        return hash ^ (hash >> 32);
     }
-    return hash;
-}
+    static bool equal(Value a, Value b) { return a.raw == b.raw; }
+};
+
+/// The 🔣 keys of 🔖, which are stored as integers so that no undefined bits are compared.
+struct SymbolKeys : IntegerKeys {
+    static const EmojicodeInteger type = T_SYMBOL;
+    static Value argument(Thread *thread) { return static_cast<EmojicodeInteger>(thread->variable(0).character); }
+};
+
+// MARK: Internal dictionary
+
+/// The control byte of a slot that has not held an item since the table was allocated. A lookup ends at a group with
+/// an empty slot.
+const uint8_t controlEmpty = 0x80;
+/// The control byte of a slot whose item was removed. Lookups must probe past it.
+const uint8_t controlDeleted = 0xFE;
+// The control byte of a full slot is the lower seven bits of the hash of its key. Its most significant bit is clear.
 
-EmojicodeDictionaryHash dictionaryHash(Object *key) {
-    auto string = key->val<String>();
-    return fnv64(string->characters(), (string->length) * sizeof(EmojicodeChar));
+inline bool isFull(uint8_t control) {
+    return (control & 0x80) == 0;
 }
 
-bool dictionaryKeyEqual(Object *key1, Object *key2) {
-    return stringEqual(key1->val<String>(), key2->val<String>());
+inline uint8_t controlHash(EmojicodeDictionaryHash hash) {
+    return hash & 0x7F;
 }
 
-bool dictionaryKeyHashEqual(EmojicodeDictionaryHash hash1, EmojicodeDictionaryHash hash2, Object *key1, Object *key2) {
-    return (hash1 == hash2) && dictionaryKeyEqual(key1, key2);
+/// Returns the number of items that can be stored in a table of @c capacity slots. At least one slot always remains
+/// empty, so that lookups terminate.
+inline size_t maximumLoad(size_t capacity) {
+    return capacity - capacity / 8;
 }
 
-// MARK: Internal dictionary
+/// The control bytes of a group loaded into a word. The matching methods return a mask, in which the most significant
+/// bit of the byte of every matching slot is set. match() may report a false positive next to a true match.
+struct DictionaryGroup {
+    static const uint64_t lsbs = 0x0101010101010101;
+    static const uint64_t msbs = 0x8080808080808080;
+
+    explicit DictionaryGroup(const uint8_t *control) {
+        std::memcpy(&bytes, control, sizeof(bytes));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        bytes = __builtin_bswap64(bytes);
+#endif
+    }
 
-EmojicodeDictionaryNode* dictionaryGetNode(EmojicodeDictionary *dict, Object *key) {
-    auto hash = dictionaryHash(key);
-
-    EmojicodeDictionaryNode *e;
-    Object** bucko;
-    size_t n = 0;
-    if (dict->buckets != nullptr) {
-        bucko = dict->buckets->val<Object*>();
-        if ((n = dict->bucketsCounter) > 0) {
-            Object *firsto = bucko[hash & (n - 1)];
-            if (firsto != nullptr) {
-                e = firsto->val<EmojicodeDictionaryNode>();
-                if (dictionaryKeyHashEqual(hash, e->hash, key, e->key)) {
-                    return e;
-                }
-                Object *eo;
-                while ((eo = e->next) != nullptr) {
-                    e = eo->val<EmojicodeDictionaryNode>();
-                    if (dictionaryKeyHashEqual(hash, e->hash, key, e->key)) {
-                        return e;
-                    }
-                }
-            }
-        }
+    uint64_t match(uint8_t hash) const {
+        uint64_t x = bytes ^ (lsbs * hash);
+        return (x - lsbs) & ~x & msbs;
     }
-    return nullptr;
-}
+    uint64_t matchEmpty() const { return bytes & ~(bytes << 6) & msbs; }
+    uint64_t matchEmptyOrDeleted() const { return bytes & ~(bytes << 7) & msbs; }
 
-Object* dictionaryNewNode(EmojicodeDictionaryHash hash, RetainedObjectPointer key) {
-    Object *nodeo = newArray(sizeof(EmojicodeDictionaryNode));
-    auto *node = nodeo->val<EmojicodeDictionaryNode>();
+    /// Returns the index of the first slot in @c mask.
+    static size_t lowest(uint64_t mask) { return static_cast<size_t>(__builtin_ctzll(mask)) / 8; }
 
-    node->hash = hash;
-    node->key = key.unretainedPointer();
-    node->next = nullptr;
-    return nodeo;
-}
+    uint64_t bytes;
+};
 
-void dictionaryResize(RetainedObjectPointer dictObject) {
-    auto *dict = dictObject->val<EmojicodeDictionary>();
+static_assert(sizeof(DictionaryGroup::bytes) == DICTIONARY_GROUP_WIDTH, "A group must fit into one word.");
+
+/// Visits the groups of a table in triangular order, which reaches every group as the number of groups is a power of
+/// two.
+struct DictionaryProbe {
+    DictionaryProbe(EmojicodeDictionaryHash hash, size_t capacity)
+        : mask(capacity / DICTIONARY_GROUP_WIDTH - 1), group((hash >> 7) & mask) {}
+
+    size_t offset() const { return group * DICTIONARY_GROUP_WIDTH; }
+    void next() { group = (group + ++step) & mask; }
 
-    Object *oldBuckoo = dict->buckets;
-    size_t oldCap = (oldBuckoo == nullptr) ? 0 : dict->bucketsCounter;
-    size_t oldThr = dict->nextThreshold;
-    size_t newCap = oldCap << 1, newThr = 0;
+    size_t mask;
+    size_t group;
+    size_t step = 0;
+};
 
-    if (oldCap > 0) {
-        if (oldCap >= DICTIONARY_MAXIMUM_CAPACTIY) {
-            dict->nextThreshold = DICTIONARY_MAXIMUM_CAPACTIY_THRESHOLD;
-            return;
+template <typename Keys>
+EmojicodeDictionarySlot* dictionaryFindSlot(EmojicodeDictionary *dict, Value key, EmojicodeDictionaryHash hash) {
+    if (dict->table == nullptr) {
+        return nullptr;
+    }
+    uint8_t *control = dict->controlBytes();
+    EmojicodeDictionarySlot *slots = dict->slots();
+    for (DictionaryProbe probe(hash, dict->capacity); ; probe.next()) {
+        DictionaryGroup group(control + probe.offset());
+        for (uint64_t matches = group.match(controlHash(hash)); matches != 0; matches &= matches - 1) {
+            EmojicodeDictionarySlot *slot = &slots[probe.offset() + DictionaryGroup::lowest(matches)];
+            if (hash == slot->hash && Keys::equal(key, slot->key)) {
+                return slot;
+            }
         }
-        if (newCap < DICTIONARY_MAXIMUM_CAPACTIY && oldCap >= DICTIONARY_DEFAULT_INITIAL_CAPACITY) {
-            newThr = oldThr << 1;  // double threshold
+        if (group.matchEmpty() != 0) {
+            return nullptr;
         }
     }
-    else if (oldThr > 0) {  // initial capacity was placed in threshold
-        newCap = oldThr;
-    }
-    else {  // zero initial threshold signifies using defaults
-        newCap = DICTIONARY_DEFAULT_INITIAL_CAPACITY;
-        newThr = (size_t) (DICTIONARY_DEFAULT_LOAD_FACTOR * DICTIONARY_DEFAULT_INITIAL_CAPACITY);
-    }
+}
+
+template <typename Keys>
+EmojicodeDictionarySlot* dictionaryGetSlot(EmojicodeDictionary *dict, Value key) {
+    return dict->table == nullptr ? nullptr : dictionaryFindSlot<Keys>(dict, key, Keys::hash(key));
+}
 
-    if (newThr == 0) {
-        float ft = static_cast<float>(newCap) * dict->loadFactor;
-        newThr = (newCap < DICTIONARY_MAXIMUM_CAPACTIY && ft < (float)DICTIONARY_MAXIMUM_CAPACTIY) ? (size_t)ft : DICTIONARY_MAXIMUM_CAPACTIY_THRESHOLD;
+/// Returns the index of the first slot that is empty or deleted in the probe sequence of @c hash.
+size_t dictionaryFreeSlot(EmojicodeDictionary *dict, EmojicodeDictionaryHash hash) {
+    uint8_t *control = dict->controlBytes();
+    for (DictionaryProbe probe(hash, dict->capacity); ; probe.next()) {
+        uint64_t free = DictionaryGroup(control + probe.offset()).matchEmptyOrDeleted();
+        if (free != 0) {
+            return probe.offset() + DictionaryGroup::lowest(free);
+        }
     }
+}
 
-    Object *newBuckoo = newArray(newCap * sizeof(Object *));
-    dict = dictObject->val<EmojicodeDictionary>();
-
-    dict->buckets = newBuckoo;
-    dict->nextThreshold = newThr;
-    dict->bucketsCounter = newCap;
-
-    auto **newBucko = newBuckoo->val<Object*>();
-    if (oldBuckoo != nullptr) {
-        for (size_t j = 0; j < oldCap; ++j) {
-            auto **oldBucko = oldBuckoo->val<Object*>();
-            Object *eo = oldBucko[j];
-            if (eo != nullptr) {
-                auto *e = eo->val<EmojicodeDictionaryNode>();
-                oldBucko[j] = nullptr;
-                if (e->next == nullptr) {
-                    newBucko[e->hash & (newCap - 1)] = eo;
-                }
-                else {  // preserve order
-                    Object *loHeado = nullptr, *loTailo = nullptr;
-                    Object *hiHeado = nullptr, *hiTailo = nullptr;
-                    Object *nexto;
-                    do {
-                        e = eo->val<EmojicodeDictionaryNode>();
-                        nexto = e->next;
-                        if ((e->hash & oldCap) == 0) {
-                            if (loTailo == nullptr) {
-                                loHeado = eo;
-                            }
-                            else {
-                                auto *loTail = loTailo->val<EmojicodeDictionaryNode>();
-                                loTail->next = eo;
-                            }
-                            loTailo = eo;
-                        }
-                        else {
-                            if (hiTailo == nullptr) {
-                                hiHeado = eo;
-                            }
-                            else {
-                                auto *hiTail = hiTailo->val<EmojicodeDictionaryNode>();
-                                hiTail->next = eo;
-                            }
-                            hiTailo = eo;
-                        }
-                    } while ((eo = nexto) != nullptr);
-
-                    if (loTailo != nullptr) {
-                        auto *loTail = loTailo->val<EmojicodeDictionaryNode>();
-                        loTail->next = nullptr;
-                        newBucko[j] = loHeado;
-                    }
-                    if (hiTailo != nullptr) {
-                        auto *hiTail = hiTailo->val<EmojicodeDictionaryNode>();
-                        hiTail->next = nullptr;
-                        newBucko[j + oldCap] = hiHeado;
-                    }
-                }
-            }
+/// Moves all items into a new table with @c capacity slots, which also discards all deleted slots.
+/// @warning Garbage collector invoking
+void dictionaryRehash(RetainedObjectPointer dictObject, size_t capacity) {
+    Object *table = newArray(sizeCalculationWithOverflowProtection(capacity, 1 + sizeof(EmojicodeDictionarySlot)));
+
+    auto *dict = dictObject->val<EmojicodeDictionary>();
+    Object *oldTable = dict->table;
+    size_t oldCapacity = dict->capacity;
+
+    dict->table = table;
+    dict->capacity = capacity;
+    dict->version++;
+    dict->growthLeft = maximumLoad(capacity) - dict->size;
+    uint8_t *control = dict->controlBytes();
+    std::memset(control, controlEmpty, capacity);
+
+    if (oldTable == nullptr) {
+        return;
+    }
+    uint8_t *oldControl = oldTable->val<uint8_t>();
+    auto *oldSlots = reinterpret_cast<EmojicodeDictionarySlot *>(oldControl + oldCapacity);
+    EmojicodeDictionarySlot *slots = dict->slots();
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (isFull(oldControl[i])) {
+            size_t index = dictionaryFreeSlot(dict, oldSlots[i].hash);
+            control[index] = oldControl[i];
+            slots[index] = oldSlots[i];
         }
     }
 }
 
-Box* dictionaryPutVal(RetainedObjectPointer dictionaryObject, RetainedObjectPointer key, Thread *thread) {
-    EmojicodeDictionaryHash hash = dictionaryHash(key.unretainedPointer());
+void dictionaryReserve(RetainedObjectPointer dictionaryObject, size_t count) {
+    size_t capacity = DICTIONARY_DEFAULT_INITIAL_CAPACITY;
+    while (maximumLoad(capacity) < count) {
+        capacity *= 2;
+    }
+    if (capacity > dictionaryObject->val<EmojicodeDictionary>()->capacity) {
+        dictionaryRehash(dictionaryObject, capacity);
+    }
+}
 
+/// Returns the slot of @c key, whose hash is @c hash. If the key is not in the dictionary, a free slot is claimed for
+/// it. The caller must store the key in the returned slot, as an object passed as @c key may have been moved.
+/// @warning Garbage collector invoking
+template <typename Keys>
+EmojicodeDictionarySlot* dictionaryClaimSlot(RetainedObjectPointer dictionaryObject, Value key,
+                                             EmojicodeDictionaryHash hash) {
     auto *dictionary = dictionaryObject->val<EmojicodeDictionary>();
-    if (dictionary->buckets == nullptr || dictionary->bucketsCounter == 0) {
-        dictionaryResize(dictionaryObject);
+    EmojicodeDictionarySlot *slot = dictionaryFindSlot<Keys>(dictionary, key, hash);
+    if (slot != nullptr) {  // existing mapping for key
+        return slot;
+    }
+
+    if (dictionary->table == nullptr) {
+        dictionaryRehash(dictionaryObject, DICTIONARY_DEFAULT_INITIAL_CAPACITY);
+        dictionary = dictionaryObject->val<EmojicodeDictionary>();
+    }
+    size_t index = dictionaryFreeSlot(dictionary, hash);
+    if (dictionary->growthLeft == 0 && dictionary->controlBytes()[index] == controlEmpty) {
+        // Grow unless more than half of the load is made up of deleted slots, which rehashing alone frees.
+        size_t capacity = dictionary->capacity;
+        if (dictionary->size >= maximumLoad(capacity) / 2) {
+            capacity *= 2;
+        }
+        dictionaryRehash(dictionaryObject, capacity);
         dictionary = dictionaryObject->val<EmojicodeDictionary>();
+        index = dictionaryFreeSlot(dictionary, hash);
     }
 
-    auto **buckets = dictionary->buckets->val<Object *>();
-    size_t n = dictionary->bucketsCounter, i = (hash & (n - 1));
+    uint8_t *control = dictionary->controlBytes();
+    if (control[index] == controlEmpty) {
+        dictionary->growthLeft--;
+    }
+    control[index] = controlHash(hash);
+    dictionary->size++;
+    dictionary->version++;
 
-    RetainedObjectPointer destination(nullptr);
+    slot = &dictionary->slots()[index];
+    slot->hash = hash;
+    return slot;
+}
 
-    Object *po = buckets[i];
-    if (po != nullptr) {
-        auto *p = po->val<EmojicodeDictionaryNode>();
-        Object *eo = nullptr;
-        if (dictionaryKeyHashEqual(hash, p->hash, key.unretainedPointer(), p->key)) {
-            eo = po;
-        }
-        else {
-            for (int binCount = 0; ; ++binCount) {
-                if (p->next == nullptr) {
-                    p->next = dictionaryNewNode(hash, key);
-                    destination = thread->retain(p->next);
-                    dictionary = dictionaryObject->val<EmojicodeDictionary>();
-                    eo = nullptr;
-                    break;
-                }
-                eo = p->next;
-                auto *e = eo->val<EmojicodeDictionaryNode>();
-
-                if (dictionaryKeyHashEqual(hash, e->hash, key.unretainedPointer(), e->key)) {
-                    break;
-                }
-                p = e;
-            }
-        }
-        if (eo != nullptr) {  // existing mapping for key
-            auto *e = eo->val<EmojicodeDictionaryNode>();
-            return &e->value;
-        }
+Box* dictionaryPutVal(RetainedObjectPointer dictionaryObject, RetainedObjectPointer key, Thread *thread) {
+    EmojicodeDictionaryHash hash = StringKeys::hash(key.unretainedPointer());
+    EmojicodeDictionarySlot *slot = dictionaryClaimSlot<StringKeys>(dictionaryObject, key.unretainedPointer(), hash);
+    slot->key = key.unretainedPointer();
+    return &slot->value;
+}
+
+template <typename Keys>
+void dictionaryRemove(EmojicodeDictionary *dictionary, Value key) {
+    EmojicodeDictionarySlot *slot = dictionaryGetSlot<Keys>(dictionary, key);
+    if (slot == nullptr) {
+        return;
     }
-    else {
-        buckets[i] = dictionaryNewNode(hash, key);
-        destination = thread->retain(buckets[i]);
-        dictionary = dictionaryObject->val<EmojicodeDictionary>();
+    size_t index = slot - dictionary->slots();
+    uint8_t *control = dictionary->controlBytes();
+    // If the group has an empty slot, no lookup has ever probed past it and the slot can become empty again.
+    if (DictionaryGroup(control + (index & ~size_t(DICTIONARY_GROUP_WIDTH - 1))).matchEmpty() != 0) {
+        control[index] = controlEmpty;
+        dictionary->growthLeft++;
     }
-
-    if (++dictionary->size > dictionary->nextThreshold) {
-        dictionaryResize(dictionaryObject);
+    else {
+        control[index] = controlDeleted;
     }
-    thread->release(1);
-    return &destination->val<EmojicodeDictionaryNode>()->value;
+    dictionary->size--;
+    dictionary->version++;
 }
 
 void dictionaryRemove(EmojicodeDictionary *dictionary, Object *key) {
-    auto hash = dictionaryHash(key);
-    size_t n = 0, index = 0;
-    if (dictionary->buckets != nullptr && (n = dictionary->bucketsCounter) > 0) {
-        auto **bucko = dictionary->buckets->val<Object*>();
-        Object *po = bucko[index = hash & (n - 1)];
-        if (po != nullptr) {
-            auto *p = po->val<EmojicodeDictionaryNode>();
-            EmojicodeDictionaryNode *node = nullptr;
-            if (dictionaryKeyHashEqual(hash, p->hash, key, p->key)) {
-                node = p;
-            }
-            else {
-                Object *nexto = p->next;
-                while (nexto != nullptr) {
-                    auto *e = nexto->val<EmojicodeDictionaryNode>();
-                    if (dictionaryKeyHashEqual(hash, e->hash, key, e->key)) {
-                        node = e;
-                        break;
-                    }
-                    p = e;
-                    nexto = e->next;
-                }
-            }
-            if (node != nullptr) {
-                if (node == p) {
-                    bucko[index] = node->next;
-                }
-                else {
-                    p->next = node->next;
-                }
-                dictionary->size--;
-            }
-        }
-    }
+    dictionaryRemove<StringKeys>(dictionary, key);
 }
 
 size_t dictionaryClear(EmojicodeDictionary *dict) {
     size_t sizeBefore = dict->size;
-    dict->loadFactor = DICTIONARY_DEFAULT_LOAD_FACTOR;
-    dict->size = 0;
-    dict->buckets = nullptr;
-    dict->nextThreshold = 0;
+    size_t version = dict->version;
+    dictionaryInit(dict);
+    dict->version = version + 1;
     return sizeBefore;
 }
 
 void dictionaryInit(EmojicodeDictionary *dict) {
-    dict->loadFactor = DICTIONARY_DEFAULT_LOAD_FACTOR;
+    dict->table = nullptr;
+    dict->capacity = 0;
+    dict->size = 0;
+    dict->growthLeft = 0;
+    dict->version = 0;
+}
+
+void dictionaryMarkSlots(Object *object, bool keysAreObjects) {
+    auto *dict = object->val<EmojicodeDictionary>();
+    if (dict->table == nullptr) {
+        return;
+    }
+    mark(&dict->table);
+
+    uint8_t *control = dict->controlBytes();
+    EmojicodeDictionarySlot *slots = dict->slots();
+    for (size_t i = 0; i < dict->capacity; i++) {
+        if (isFull(control[i])) {
+            if (keysAreObjects) {
+                mark(&slots[i].key.object);
+            }
+            if (slots[i].value.type.raw == T_OBJECT || (slots[i].value.type.raw & REMOTE_MASK) != 0) {
+                mark(&slots[i].value.value1.object);
+            }
+        }
+    }
 }
 
 void dictionaryMark(Object *object) {
-//    EmojicodeDictionary *dict = static_cast<EmojicodeDictionary *>(object->value);
-//
-//    if(dict->buckets == nullptr){
-//        return;
-//    }
-//    mark(&dict->buckets);
-//
-//    Object **buckets = static_cast<Object **>(dict->buckets->value);
-//    for (size_t i = 0; i < dict->bucketsCounter; i++) {
-//        Object **eo = &buckets[i];
-//        while (*(eo)) {
-//            mark(eo);
-//            EmojicodeDictionaryNode *e = static_cast<EmojicodeDictionaryNode *>((*eo)->value);
-//            mark(&(e->key));
-//            if (isRealObject(e->value)){
-//                mark(&(e->value.object));
-//            }
-//            eo = &(e->next);
-//        }
-//    }
+    dictionaryMarkSlots(object, true);
+}
+
+void primitiveKeyDictionaryMark(Object *object) {
+    dictionaryMarkSlots(object, false);
+}
+
+void dictionaryEnumeratorMark(Object *object) {
+    mark(&object->val<EmojicodeDictionaryEnumerator>()->dictionary);
 }
 
 // MARK: Bridges
 
-void bridgeDictionarySet(Thread *thread) {
-    dictionaryPutVal(thread->thisObjectAsRetained(),
-                     thread->variableObjectPointerAsRetained(0), thread)->copy(thread->variableDestination(1));
+template <typename Keys>
+void dictionarySet(Thread *thread) {
+    Value key = Keys::argument(thread);
+    EmojicodeDictionarySlot *slot = dictionaryClaimSlot<Keys>(thread->thisObjectAsRetained(), key, Keys::hash(key));
+    slot->key = Keys::argument(thread);
+    slot->value.copy(thread->variableDestination(1));
     thread->returnFromFunction();
 }
 
-void bridgeDictionaryGet(Thread *thread) {
-    Object *key = thread->variable(0).object;
+template <typename Keys>
+void dictionaryGet(Thread *thread) {
     auto *dictionary = thread->thisObject()->val<EmojicodeDictionary>();
-    EmojicodeDictionaryNode *node = dictionaryGetNode(dictionary, key);
-    if (node == nullptr) {
+    EmojicodeDictionarySlot *slot = dictionaryGetSlot<Keys>(dictionary, Keys::argument(thread));
+    if (slot == nullptr) {
         thread->returnNothingnessFromFunction();
     }
     else {
-        node->value.copyTo(thread->currentStackFrame()->destination);
+        slot->value.copyTo(thread->currentStackFrame()->destination);
         thread->returnFromFunction();
     }
 }
 
-void bridgeDictionaryRemove(Thread *thread) {
-    dictionaryRemove(thread->thisObject()->val<EmojicodeDictionary>(), thread->variable(0).object);
+template <typename Keys>
+void dictionaryRemove(Thread *thread) {
+    dictionaryRemove<Keys>(thread->thisObject()->val<EmojicodeDictionary>(), Keys::argument(thread));
     thread->returnFromFunction();
 }
 
-void bridgeDictionaryKeys(Thread *thread) {
+template <typename Keys>
+void dictionaryKeys(Thread *thread) {
     auto listObject = thread->retain(newObject(CL_LIST));
 
-    auto *dict = thread->thisObject()->val<EmojicodeDictionary>();
-
-    listObject->val<List>()->capacity = dict->size;
-    Object *items = newArray(sizeof(Box) * dict->size);
+    size_t size = thread->thisObject()->val<EmojicodeDictionary>()->size;
+    Object *items = newArray(sizeCalculationWithOverflowProtection(size, sizeof(Box)));
+    listObject->val<List>()->capacity = size;
     listObject->val<List>()->items = items;
 
-    for (size_t i = 0, l = dict->bucketsCounter; i < l; i++) {
-        auto **bucko = thread->thisObject()->val<EmojicodeDictionary>()->buckets->val<Object*>();
-        if (bucko[i] != nullptr) {
-            auto nodeo = thread->retain(bucko[i]);
-            while (true) {
-                listAppendDestination(listObject, thread)->copySingleValue(T_OBJECT,
-                                                                           nodeo->val<EmojicodeDictionaryNode>()->key);
-                auto next = nodeo->val<EmojicodeDictionaryNode>()->next;
-                if (next == nullptr) {
-                    break;
-                }
-                nodeo = next;
-            }
-            thread->release(1);
+    auto *dict = thread->thisObject()->val<EmojicodeDictionary>();
+    Box *keys = items->val<Box>();
+    for (size_t i = 0, count = 0; count < size; i++) {
+        if (isFull(dict->controlBytes()[i])) {
+            keys[count++].copySingleValue(Keys::type, dict->slots()[i].key);
         }
     }
+    listObject->val<List>()->count = size;
 
     thread->release(1);
     thread->returnFromFunction(listObject.unretainedPointer());
 }
 
+template <typename Keys>
+void dictionaryContains(Thread *thread) {
+    auto dictionary = thread->thisObject()->val<EmojicodeDictionary>();
+    thread->returnFromFunction(dictionaryGetSlot<Keys>(dictionary, Keys::argument(thread)) != nullptr);
+}
+
+/// Returns a new 🔭 that enumerates the dictionary on which the method was called.
+template <typename Keys>
+void dictionaryEnumerator(Thread *thread) {
+    Object *enumeratorObject = newObject(CL_DICTIONARY_ENUMERATOR);
+    auto *enumerator = enumeratorObject->val<EmojicodeDictionaryEnumerator>();
+    enumerator->dictionary = thread->thisObject();
+    enumerator->version = thread->thisObject()->val<EmojicodeDictionary>()->version;
+    enumerator->current = SIZE_MAX;
+    enumerator->next = 0;
+    enumerator->keyType = Keys::type;
+    thread->returnFromFunction(enumeratorObject);
+}
+
+void bridgeDictionarySet(Thread *thread) {
+    dictionarySet<StringKeys>(thread);
+}
+
+void bridgeDictionaryGet(Thread *thread) {
+    dictionaryGet<StringKeys>(thread);
+}
+
+void bridgeDictionaryRemove(Thread *thread) {
+    dictionaryRemove<StringKeys>(thread);
+}
+
+void bridgeDictionaryKeys(Thread *thread) {
+    dictionaryKeys<StringKeys>(thread);
+}
+
+void bridgeDictionaryEnumerator(Thread *thread) {
+    dictionaryEnumerator<StringKeys>(thread);
+}
+
 void bridgeDictionaryClear(Thread *thread) {
     auto c = static_cast<EmojicodeInteger>(dictionaryClear(thread->thisObject()->val<EmojicodeDictionary>()));
     thread->returnFromFunction(c);
 }
 
 void bridgeDictionaryContains(Thread *thread) {
-    Object *key = thread->variable(0).object;
-    auto dictionary = thread->thisObject()->val<EmojicodeDictionary>();
-    thread->returnFromFunction(dictionaryGetNode(dictionary, key) != nullptr);
+    dictionaryContains<StringKeys>(thread);
 }
 
 void bridgeDictionarySize(Thread *thread) {
     thread->returnFromFunction(static_cast<EmojicodeInteger>(thread->thisObject()->val<EmojicodeDictionary>()->size));
 }
 
+void bridgeIntegerDictionarySet(Thread *thread) {
+    dictionarySet<IntegerKeys>(thread);
+}
+
+void bridgeIntegerDictionaryGet(Thread *thread) {
+    dictionaryGet<IntegerKeys>(thread);
+}
+
+void bridgeIntegerDictionaryRemove(Thread *thread) {
+    dictionaryRemove<IntegerKeys>(thread);
+}
+
+void bridgeIntegerDictionaryKeys(Thread *thread) {
+    dictionaryKeys<IntegerKeys>(thread);
+}
+
+void bridgeIntegerDictionaryContains(Thread *thread) {
+    dictionaryContains<IntegerKeys>(thread);
+}
+
+void bridgeIntegerDictionaryEnumerator(Thread *thread) {
+    dictionaryEnumerator<IntegerKeys>(thread);
+}
+
+void bridgeSymbolDictionarySet(Thread *thread) {
+    dictionarySet<SymbolKeys>(thread);
+}
+
+void bridgeSymbolDictionaryGet(Thread *thread) {
+    dictionaryGet<SymbolKeys>(thread);
+}
+
+void bridgeSymbolDictionaryRemove(Thread *thread) {
+    dictionaryRemove<SymbolKeys>(thread);
+}
+
+void bridgeSymbolDictionaryKeys(Thread *thread) {
+    dictionaryKeys<SymbolKeys>(thread);
+}
+
+void bridgeSymbolDictionaryContains(Thread *thread) {
+    dictionaryContains<SymbolKeys>(thread);
+}
+
+void bridgeSymbolDictionaryEnumerator(Thread *thread) {
+    dictionaryEnumerator<SymbolKeys>(thread);
+}
+
+/// Returns the dictionary enumerated by the 🔭 on which the method was called. Reports an error if the dictionary was
+/// modified since the enumerator was created.
+EmojicodeDictionary* enumeratedDictionary(EmojicodeDictionaryEnumerator *enumerator) {
+    auto *dict = enumerator->dictionary->val<EmojicodeDictionary>();
+    if (dict->version != enumerator->version) {
+        error("The dictionary was modified while it was being enumerated.");
+    }
+    return dict;
+}
+
+/// Moves enumerator->next to the next full slot or to the end of the table.
+void dictionaryEnumeratorAdvance(EmojicodeDictionaryEnumerator *enumerator, EmojicodeDictionary *dict) {
+    if (dict->table == nullptr) {
+        return;
+    }
+    uint8_t *control = dict->controlBytes();
+    while (enumerator->next < dict->capacity && !isFull(control[enumerator->next])) {
+        enumerator->next++;
+    }
+}
+
+void dictionaryEnumeratorNext(Thread *thread) {
+    auto *enumerator = thread->thisObject()->val<EmojicodeDictionaryEnumerator>();
+    EmojicodeDictionary *dict = enumeratedDictionary(enumerator);
+    dictionaryEnumeratorAdvance(enumerator, dict);
+    if (enumerator->next >= dict->capacity) {
+        error("🔽 was called on a 🔭 that has no more items.");
+    }
+    enumerator->current = enumerator->next++;
+    thread->returnFromFunction(thread->thisContext());
+}
+
+void dictionaryEnumeratorHasNext(Thread *thread) {
+    auto *enumerator = thread->thisObject()->val<EmojicodeDictionaryEnumerator>();
+    EmojicodeDictionary *dict = enumeratedDictionary(enumerator);
+    dictionaryEnumeratorAdvance(enumerator, dict);
+    thread->returnFromFunction(enumerator->next < dict->capacity);
+}
+
+/// Returns the slot of the item last returned by 🔽.
+EmojicodeDictionarySlot* enumeratedSlot(EmojicodeDictionaryEnumerator *enumerator) {
+    EmojicodeDictionary *dict = enumeratedDictionary(enumerator);
+    if (enumerator->current >= dict->capacity) {
+        error("🔽 must be called on a 🔭 before its current item can be accessed.");
+    }
+    return &dict->slots()[enumerator->current];
+}
+
+void dictionaryEnumeratorKey(Thread *thread) {
+    auto *enumerator = thread->thisObject()->val<EmojicodeDictionaryEnumerator>();
+    EmojicodeDictionarySlot *slot = enumeratedSlot(enumerator);
+    Box(enumerator->keyType, slot->key).copyTo(thread->currentStackFrame()->destination);
+    thread->returnFromFunction();
+}
+
+void dictionaryEnumeratorValue(Thread *thread) {
+    auto *enumerator = thread->thisObject()->val<EmojicodeDictionaryEnumerator>();
+    EmojicodeDictionarySlot *slot = enumeratedSlot(enumerator);
+    slot->value.copyTo(thread->currentStackFrame()->destination);
+    thread->returnFromFunction();
+}
+
 void initDictionaryBridge(Thread *thread) {
     dictionaryInit(thread->thisObject()->val<EmojicodeDictionary>());
     thread->returnFromFunction(thread->thisContext());
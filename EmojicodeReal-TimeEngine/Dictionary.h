@@ -13,46 +13,72 @@
 
 namespace Emojicode {
 
-/** Default initial capacity. MUST be a power of two, default: 8 */
+/** The number of control bytes that are examined at once. Slots are probed in groups of this size. */
+#define DICTIONARY_GROUP_WIDTH 8
+/** Default initial capacity. MUST be a power of two and at least DICTIONARY_GROUP_WIDTH, default: 8 */
 #define DICTIONARY_DEFAULT_INITIAL_CAPACITY (1 << 3)
-/** Factor for determining whether the dictionary should be resized. */
-#define DICTIONARY_DEFAULT_LOAD_FACTOR (0.75f)
-#define DICTIONARY_MAXIMUM_CAPACTIY (1 << 30)
-#define DICTIONARY_MAXIMUM_CAPACTIY_THRESHOLD (1 << 16)
 
 typedef uint64_t EmojicodeDictionaryHash;
 
-/** The datastructure with the key-value pair */
-struct EmojicodeDictionaryNode {
-    /** The user specified key. */
-    Object *key;
+/** A slot of the table, which holds a key-value pair if its control byte says so. */
+struct EmojicodeDictionarySlot {
+    /** The user specified key. A 🔡 for 🍯, the integer or symbol itself for 📒 and 🔖. */
+    Value key;
 
     /** The user specified value. */
     Box value;
 
     /** The cached hash for the key. Calculated on item addition. */
     EmojicodeDictionaryHash hash;
-
-    /** EmojicodeDictionary stores a bucket's elements in a linked list. */
-    Object *next;
 };
 
-/** Structure for the Emojicode standard Dictionary. The implementation is similar to Java's Hashmap. */
+/**
+ * Structure for the Emojicode standard Dictionary. The implementation is an open-addressing hash table in the style of
+ * Swiss tables: Every slot has a control byte, which tells whether the slot is empty, deleted or full and, if it is
+ * full, holds seven bits of the hash of its key. A lookup compares a whole group of control bytes with these bits at
+ * once and only looks at the slots that match.
+ *
+ * The structure is shared by 🍯, which has 🔡 keys, and by 📒 and 🔖, which store their 🚂 and 🔣 keys unboxed.
+ */
 struct EmojicodeDictionary {
-    /** An array with pointers to linked lists. Initializes when the first item is inserted. */
-    Object *buckets;
+    /** An array with the control bytes followed by the slots. Initializes when the first item is inserted. */
+    Object *table;
 
-    /** Length of buckets array. */
-    size_t bucketsCounter;
+    /** The number of slots. Either 0 or a power of two that is at least DICTIONARY_GROUP_WIDTH. */
+    size_t capacity;
 
-    /** The number of items stored in this dictionary. Used for determining whether to resize. */
+    /** The number of items stored in this dictionary. */
     size_t size;
 
-    /** When size * loadFactor >= bucketsCounter the dictionary doubles the amount of buckets */
-    float loadFactor;
+    /** The number of items that can still be stored in empty slots before the table is rehashed. */
+    size_t growthLeft;
+
+    /** Incremented whenever a key is added or removed or the table is rehashed. Enumerators compare it to detect that
+        the dictionary was modified. */
+    size_t version;
 
-    /** Stores the next threshold for resizing. Is 0 until first resize when item is inserted. */
-    size_t nextThreshold;
+    uint8_t* controlBytes() { return table->val<uint8_t>(); }
+    EmojicodeDictionarySlot* slots() {
+        return reinterpret_cast<EmojicodeDictionarySlot *>(table->val<uint8_t>() + capacity);
+    }
+};
+
+/** The value area of 🔭, which enumerates the items of a dictionary in the order of their slots. */
+struct EmojicodeDictionaryEnumerator {
+    /** The 🍯, 📒 or 🔖 that is enumerated. */
+    Object *dictionary;
+
+    /** The version of the dictionary when the enumerator was created. */
+    size_t version;
+
+    /** The slot of the item last returned by 🔽, or SIZE_MAX before 🔽 was called. */
+    size_t current;
+
+    /** The slot at which the search for the next item starts. */
+    size_t next;
+
+    /** The type with which the keys are boxed. */
+    EmojicodeInteger keyType;
 };
 
 /// Prepares the dictionary for a new value and returns a pointer to where the new value should be copied.
@@ -60,9 +86,15 @@ struct EmojicodeDictionary {
 Box* dictionaryPutVal(RetainedObjectPointer dictionaryObject, RetainedObjectPointer key, Thread *thread);
 /// Removes the key and the associated value from the dictionary, if the key @c key is in the dictionary.
 void dictionaryRemove(EmojicodeDictionary *dictionary, Object *key);
+/// Makes room for @c count items so that they can be added without rehashing.
+/// @warning Garbage collector invoking
+void dictionaryReserve(RetainedObjectPointer dictionaryObject, size_t count);
 
 
 void dictionaryMark(Object *dict);
+/// The marker of 📒 and 🔖, whose keys are not objects.
+void primitiveKeyDictionaryMark(Object *dict);
+void dictionaryEnumeratorMark(Object *enumerator);
 
 void initDictionaryBridge(Thread *thread);
 void dictionaryInit(EmojicodeDictionary *dict);
@@ -74,6 +106,26 @@ void bridgeDictionaryKeys(Thread *thread);
 void bridgeDictionaryClear(Thread *thread);
 void bridgeDictionaryContains(Thread *thread);
 void bridgeDictionarySize(Thread *thread);
+void bridgeDictionaryEnumerator(Thread *thread);
+
+void bridgeIntegerDictionarySet(Thread *thread);
+void bridgeIntegerDictionaryGet(Thread *thread);
+void bridgeIntegerDictionaryRemove(Thread *thread);
+void bridgeIntegerDictionaryKeys(Thread *thread);
+void bridgeIntegerDictionaryContains(Thread *thread);
+void bridgeIntegerDictionaryEnumerator(Thread *thread);
+
+void bridgeSymbolDictionarySet(Thread *thread);
+void bridgeSymbolDictionaryGet(Thread *thread);
+void bridgeSymbolDictionaryRemove(Thread *thread);
+void bridgeSymbolDictionaryKeys(Thread *thread);
+void bridgeSymbolDictionaryContains(Thread *thread);
+void bridgeSymbolDictionaryEnumerator(Thread *thread);
+
+void dictionaryEnumeratorNext(Thread *thread);
+void dictionaryEnumeratorHasNext(Thread *thread);
+void dictionaryEnumeratorKey(Thread *thread);
+void dictionaryEnumeratorValue(Thread *thread);
 
 }
 
@@ -28,7 +28,9 @@ extern Class *CL_LIST;
 extern Class *CL_DATA;
 extern Class *CL_DICTIONARY;
 extern Class *CL_CLOSURE;
+extern Class *CL_DICTIONARY_ENUMERATOR;
 extern Class *CL_ARRAY;
+extern Class *CL_PINNED_BUFFER;
 
 /// A one-Emojicode-word large value without type information.
 union Value {
@@ -52,6 +54,10 @@ union Value {
     void setValueForError(Value value) { raw = T_OPTIONAL_VALUE; this[1] = value; }
 };
 
+/// The header of an object, which is immediately followed by the value area.
+///
+/// The size of an object is determined by its class. Only arrays, which are created with @c newArray, have a variable
+/// size, which is stored in an additional word in front of the header.
 struct Object {
     union {
         /// The class of the object
@@ -59,20 +65,18 @@ struct Object {
         /// Used by the Garbage Collector, do not change!
         Object *newLocation;
     };
-    /** The size of this object: the size of the Object struct and the value area. */
-    size_t size;
 
     template <typename T>
     inline T* val() {
 #ifdef DEBUG 
-        if (size == 0 && klass == nullptr) throw;
+        if (klass == nullptr) throw;
 #endif
         return reinterpret_cast<T*>(this + 1);
     }
 
     inline Value* variableDestination(EmojicodeInstruction index) {
 #ifdef DEBUG
-        if (size == 0 && klass == nullptr) throw;
+        if (klass == nullptr) throw;
 #endif
         return reinterpret_cast<Value *>(reinterpret_cast<Byte *>(this) + sizeof(Object) + sizeof(Value) * index);
     }
@@ -138,6 +142,19 @@ extern Object* newArray(size_t size);
  */
 extern Object* resizeArray(Object *array, size_t size, Thread *thread);
 
+/**
+ * Allocates a buffer of @c size bytes outside of the heap and returns an object representing it.
+ * Other than the value area of an array, the bytes of the buffer, which are obtained with @c pinnedBufferBytes, are
+ * never moved. They can therefore be passed to the operating system inside a @c BlockingRegion, e.g. to @c read or
+ * @c recv, without copying, or hold native synchronization primitives. The buffer is freed by the garbage collector
+ * once the object became unreachable. If @c finalizer is given, it is called with the bytes before.
+ * @warning GC-invoking
+ */
+extern Object* newPinnedBuffer(size_t size, void (*finalizer)(char *bytes) = nullptr);
+
+/// Returns the bytes of a buffer created by @c newPinnedBuffer.
+extern char* pinnedBufferBytes(Object *buffer);
+
 
 // MARK: Garbage Collection
 
@@ -168,6 +185,26 @@ extern void allowGC();
  */
 extern void disallowGCAndPauseIfNeeded();
 
+/**
+ * A scoped region in which the calling thread may block, e.g. in a system call, without holding up the garbage
+ * collector. The region begins when the object is constructed and ends when it is destroyed. Use it around every
+ * call that might wait for an undetermined amount of time.
+ *
+ * While inside the region the thread counts as paused and the garbage collector may move any object at any time.
+ * @warning You must not access objects, allocate or call GC-invoking functions inside the region. Object pointers
+ * obtained before the region are invalid after it: Read them again, e.g. with @c Thread::thisObject() or
+ * @c Thread::variable(), or @c Thread::retain() them before the region and use
+ * @c RetainedObjectPointer::unretainedPointer() after it. Data needed inside the region must be copied out of the
+ * heap beforehand.
+ */
+class BlockingRegion {
+public:
+    BlockingRegion() { allowGC(); }
+    ~BlockingRegion() { disallowGCAndPauseIfNeeded(); }
+    BlockingRegion(const BlockingRegion&) = delete;
+    BlockingRegion& operator=(const BlockingRegion&) = delete;
+};
+
 typedef void (*FunctionFunctionPointer)(Thread *thread);
 typedef void (*Marker)(Object *self);
 
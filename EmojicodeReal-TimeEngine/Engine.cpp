@@ -11,6 +11,7 @@
 #include "Memory.hpp"
 #include "Processor.hpp"
 #include "Reader.hpp"
+#include "StringKernels.hpp"
 #include "Thread.hpp"
 #include "ThreadsManager.hpp"
 #include <cstdarg>
@@ -30,9 +31,12 @@ Class *CL_DATA;
 Class *CL_DICTIONARY;
 Class *CL_CAPTURED_FUNCTION_CALL;
 Class *CL_CLOSURE;
+Class *CL_DICTIONARY_ENUMERATOR;
 
 static Class cl_array(nullptr);
 Class *CL_ARRAY = &cl_array;
+static Class cl_pinned_buffer(nullptr);
+Class *CL_PINNED_BUFFER = &cl_pinned_buffer;
 
 char **cliArguments;
 int cliArgumentCount;
@@ -81,8 +85,10 @@ int main(int argc, char *argv[]) {
     }
 
     Thread *mainThread = ThreadsManager::allocateThread();
+    Thread::setCurrent(mainThread);
 
     allocateHeap();
+    StringKernels::select();
 
     Function *handler = readBytecode(f);
     Value sth = EmojicodeInteger(0);
@@ -108,7 +108,7 @@ struct Closure {
 typedef Marker (*MarkerPointerForClass)(EmojicodeChar cl);
 typedef uint_fast32_t (*SizeForClassFunction)(Class *cl, EmojicodeChar name);
 
-extern FunctionFunctionPointer sLinkingTable[100];
+extern FunctionFunctionPointer sLinkingTable[];
 Marker markerPointerForClass(EmojicodeChar cl);
 uint_fast32_t sizeForClass(Class *cl, EmojicodeChar name);
 
@@ -0,0 +1,320 @@
+//
+//  Fiber.cpp
+//  Emojicode
+//
+
+#include "Fiber.hpp"
+#include "Engine.hpp"
+#include "Memory.hpp"
+#include "Thread.hpp"
+#include "ThreadsManager.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <deque>
+#include <fcntl.h>
+#include <map>
+#include <poll.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace Emojicode {
+namespace Fibers {
+
+/// The size of the stack on which a fiber's stack frames are allocated.
+constexpr size_t fiberStackSize = 256 * 1024;
+/// The size of the native stack on which the interpreter runs a fiber. Every call made by Emojicode code uses about
+/// half a kilobyte of it.
+constexpr size_t fiberNativeStackSize = 1024 * 1024;
+/// The native stack space that must be left when a fiber calls a function. Native functions may use it.
+constexpr size_t nativeStackReserve = 64 * 1024;
+
+struct DescriptorWait {
+    int descriptor;
+    short events;
+    Fiber *fiber;
+};
+
+/// The carriers and the poller run until the program exits. Like the task pool, the scheduler is therefore never
+/// deallocated.
+struct Scheduler {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<Fiber *> runQueue;
+    /// The number of fibers in the run queue. Read by running fibers to decide whether they should yield.
+    std::atomic_size_t runnable{0};
+
+    std::mutex pollerMutex;
+    std::vector<DescriptorWait> descriptorWaits;
+    std::multimap<std::chrono::steady_clock::time_point, Fiber *> timers;
+    /// Written to by fibers that registered a descriptor or timer to interrupt the poller's poll().
+    int wakePipe[2];
+};
+
+Scheduler *scheduler = nullptr;
+std::once_flag schedulerStarted;
+
+void makeRunnable(Fiber *fiber) {
+    {
+        std::lock_guard<std::mutex> lock(scheduler->mutex);
+        scheduler->runQueue.push_back(fiber);
+        scheduler->runnable++;
+    }
+    scheduler->condition.notify_one();
+}
+
+void carry() {
+    ucontext_t carrierContext;
+    while (true) {
+        Fiber *fiber;
+        {
+            std::unique_lock<std::mutex> lock(scheduler->mutex);
+            scheduler->condition.wait(lock, [] { return !scheduler->runQueue.empty(); });
+            fiber = scheduler->runQueue.front();
+            scheduler->runQueue.pop_front();
+            scheduler->runnable--;
+        }
+        fiber->carrierContext = &carrierContext;
+        Thread::setCurrent(fiber->thread);
+        swapcontext(&carrierContext, &fiber->context);
+        Thread::setCurrent(nullptr);
+        switch (fiber->next) {
+            case Fiber::Next::Yield:
+                makeRunnable(fiber);
+                break;
+            case Fiber::Next::Park:
+                // The fiber is only now off its native stack and can be resumed. If it was unparked in the meantime,
+                // whoever clears parked first requeues it.
+                fiber->parked = true;
+                if (fiber->permit.exchange(false) && fiber->parked.exchange(false)) {
+                    makeRunnable(fiber);
+                }
+                break;
+            case Fiber::Next::Finish:
+                ThreadsManager::deallocateThread(fiber->thread);
+                delete fiber;
+                break;
+        }
+    }
+}
+
+void wakePoller() {
+    char byte = 0;
+    while (write(scheduler->wakePipe[1], &byte, 1) < 0 && errno == EINTR);
+}
+
+void runPoller() {
+    std::vector<pollfd> descriptors;
+    std::unordered_map<int, short> ready;
+    while (true) {
+        int timeout = -1;
+        {
+            std::lock_guard<std::mutex> lock(scheduler->pollerMutex);
+            auto now = std::chrono::steady_clock::now();
+            auto &timers = scheduler->timers;
+            while (!timers.empty() && timers.begin()->first <= now) {
+                unpark(timers.begin()->second);
+                timers.erase(timers.begin());
+            }
+            if (!timers.empty()) {
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(timers.begin()->first - now);
+                timeout = static_cast<int>(wait.count()) + 1;
+            }
+            descriptors.clear();
+            descriptors.push_back(pollfd{scheduler->wakePipe[0], POLLIN, 0});
+            for (auto &wait : scheduler->descriptorWaits) {
+                descriptors.push_back(pollfd{wait.descriptor, wait.events, 0});
+            }
+        }
+
+        if (poll(descriptors.data(), descriptors.size(), timeout) <= 0) {
+            continue;
+        }
+
+        if (descriptors[0].revents != 0) {
+            char buffer[64];
+            while (read(scheduler->wakePipe[0], buffer, sizeof(buffer)) > 0);
+        }
+        ready.clear();
+        for (size_t i = 1; i < descriptors.size(); i++) {
+            if (descriptors[i].revents != 0) {
+                ready[descriptors[i].fd] |= descriptors[i].revents;
+            }
+        }
+        if (ready.empty()) {
+            continue;
+        }
+
+        // Fibers remove their registrations when they are woken for another reason, so waits are matched by
+        // descriptor rather than by their position.
+        std::lock_guard<std::mutex> lock(scheduler->pollerMutex);
+        auto &waits = scheduler->descriptorWaits;
+        waits.erase(std::remove_if(waits.begin(), waits.end(), [&ready](const DescriptorWait &wait) {
+            auto it = ready.find(wait.descriptor);
+            if (it == ready.end() || (it->second & (wait.events | POLLERR | POLLHUP | POLLNVAL)) == 0) {
+                return false;
+            }
+            unpark(wait.fiber);
+            return true;
+        }), waits.end());
+    }
+}
+
+void startScheduler() {
+    scheduler = new Scheduler;
+    if (pipe(scheduler->wakePipe) != 0) {
+        error("Could not create the pipe to wake the fiber poller.");
+    }
+    fcntl(scheduler->wakePipe[0], F_SETFL, fcntl(scheduler->wakePipe[0], F_GETFL) | O_NONBLOCK);
+    fcntl(scheduler->wakePipe[1], F_SETFL, fcntl(scheduler->wakePipe[1], F_GETFL) | O_NONBLOCK);
+
+    unsigned int carriers = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int i = 0; i < carriers; i++) {
+        std::thread(carry).detach();
+    }
+    std::thread(runPoller).detach();
+}
+
+/// Switches from the fiber to its carrier, which then handles the fiber as described by @c next. Returns once the
+/// fiber was resumed, possibly on another carrier.
+void switchToCarrier(Fiber *fiber, Fiber::Next next) {
+    fiber->next = next;
+    fiber->budget = timeSlice;
+    allowGC();
+    swapcontext(&fiber->context, fiber->carrierContext);
+    disallowGCAndPauseIfNeeded();
+}
+
+void finish(Fiber *fiber) {
+    auto state = reinterpret_cast<FiberState *>(pinnedBufferBytes(fiber->state.unretainedPointer()));
+    {
+        // A joiner that sees finished may return and finish itself, so it must be unparked before the mutex is
+        // released.
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->finished = true;
+        for (auto joiner : state->joiners) {
+            unpark(joiner);
+        }
+        state->joiners.clear();
+    }
+    state->condition.notify_all();
+
+    // The garbage collector cannot run before the carrier deallocated the thread, as the fiber does not count as
+    // paused after it released its objects.
+    fiber->thread->release(2);
+    fiber->next = Fiber::Next::Finish;
+    swapcontext(&fiber->context, fiber->carrierContext);
+}
+
+void fiberMain(unsigned int high, unsigned int low) {
+    auto fiber = reinterpret_cast<Fiber *>(static_cast<uintptr_t>(high) << 32 | low);
+    disallowGCAndPauseIfNeeded();
+    executeCallableExtern(fiber->callable.unretainedPointer(), nullptr, 0, fiber->thread, nullptr);
+    finish(fiber);
+}
+
+void spawn(Object *callable, Object *state) {
+    std::call_once(schedulerStarted, startScheduler);
+
+    Thread *thread = ThreadsManager::allocateThread(fiberStackSize, fiberNativeStackSize);
+    auto fiber = new Fiber(thread, thread->retain(callable), thread->retain(state));
+    thread->fiber_ = fiber;
+
+    auto nativeStack = thread->nativeStack_;
+    fiber->nativeStackLimit = nativeStack + nativeStackReserve;
+    fiber->budget = timeSlice;
+    getcontext(&fiber->context);
+    fiber->context.uc_stack.ss_sp = nativeStack;
+    fiber->context.uc_stack.ss_size = thread->nativeStackSize_;
+    fiber->context.uc_link = nullptr;
+    auto address = reinterpret_cast<uintptr_t>(fiber);
+    makecontext(&fiber->context, reinterpret_cast<void (*)()>(fiberMain), 2,
+                static_cast<unsigned int>(address >> 32), static_cast<unsigned int>(address));
+
+    // The new fiber counts as paused until a carrier runs it.
+    allowGC();
+    makeRunnable(fiber);
+}
+
+void yield(Thread *thread) {
+    switchToCarrier(thread->fiber(), Fiber::Next::Yield);
+}
+
+void park(Thread *thread) {
+    Fiber *fiber = thread->fiber();
+    if (fiber->permit.exchange(false)) {
+        return;
+    }
+    switchToCarrier(fiber, Fiber::Next::Park);
+}
+
+void unpark(Fiber *fiber) {
+    fiber->permit = true;
+    if (fiber->parked.exchange(false)) {
+        fiber->permit = false;
+        makeRunnable(fiber);
+    }
+}
+
+void sleepUntil(Thread *thread, std::chrono::steady_clock::time_point deadline) {
+    Fiber *fiber = thread->fiber();
+    while (std::chrono::steady_clock::now() < deadline) {
+        {
+            std::lock_guard<std::mutex> lock(scheduler->pollerMutex);
+            scheduler->timers.emplace(deadline, fiber);
+        }
+        wakePoller();
+        park(thread);
+        std::lock_guard<std::mutex> lock(scheduler->pollerMutex);
+        auto range = scheduler->timers.equal_range(deadline);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == fiber) {
+                scheduler->timers.erase(it);
+                break;
+            }
+        }
+    }
+}
+
+void waitForDescriptor(Thread *thread, int descriptor, bool write) {
+    Fiber *fiber = thread->fiber();
+    if (fiber == nullptr) {
+        return;
+    }
+    short events = write ? POLLOUT : POLLIN;
+    while (true) {
+        // Errors are left to be reported by the operation the fiber is about to perform.
+        pollfd check = {descriptor, events, 0};
+        if (poll(&check, 1, 0) != 0) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(scheduler->pollerMutex);
+            scheduler->descriptorWaits.push_back(DescriptorWait{descriptor, events, fiber});
+        }
+        wakePoller();
+        park(thread);
+        std::lock_guard<std::mutex> lock(scheduler->pollerMutex);
+        auto &waits = scheduler->descriptorWaits;
+        waits.erase(std::remove_if(waits.begin(), waits.end(), [fiber](const DescriptorWait &wait) {
+            return wait.fiber == fiber;
+        }), waits.end());
+    }
+}
+
+void checkpoint(Thread *thread) {
+    Fiber *fiber = thread->fiber();
+    if (static_cast<Byte *>(__builtin_frame_address(0)) < fiber->nativeStackLimit) {
+        error("Your program triggerd a stack overflow!");
+    }
+    if (--fiber->budget == 0) {
+        fiber->budget = timeSlice;
+        if (scheduler->runnable > 0) {
+            yield(thread);
+        }
+    }
+}
+
+}  // namespace Fibers
+}  // namespace Emojicode
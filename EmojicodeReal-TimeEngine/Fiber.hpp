@@ -0,0 +1,85 @@
+//
+//  Fiber.hpp
+//  Emojicode
+//
+
+#ifndef Fiber_hpp
+#define Fiber_hpp
+
+#include "EmojicodeAPI.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <ucontext.h>
+#include <vector>
+
+namespace Emojicode {
+
+/// A lightweight thread of execution that is multiplexed together with all other fibers onto a small pool of carrier
+/// threads.
+///
+/// Every fiber is backed by a Thread, whose stack is walked by the garbage collector like any other. While a fiber is
+/// not running on a carrier it counts as paused. A running fiber yields its carrier at calls and backward branches
+/// once its time slice is used up, and parks whenever it waits for another fiber, a timer or a file descriptor.
+struct Fiber {
+    Fiber(Thread *thread, RetainedObjectPointer callable, RetainedObjectPointer state)
+        : thread(thread), callable(callable), state(state) {}
+
+    Thread *thread;
+    /// The callable the fiber calls and the pinned buffer containing its FiberState, both retained by @c thread.
+    RetainedObjectPointer callable;
+    RetainedObjectPointer state;
+    ucontext_t context;
+    /// The context of the carrier that currently runs the fiber.
+    ucontext_t *carrierContext;
+    /// The lowest address the native stack may grow to before a stack overflow is reported.
+    Byte *nativeStackLimit;
+    /// The number of safepoints the fiber passes before it yields.
+    unsigned int budget = 0;
+    /// Tells the carrier what to do with the fiber after it switched back.
+    enum class Next { Yield, Park, Finish } next = Next::Yield;
+    /// Set if the fiber was unparked since it last parked.
+    std::atomic_bool permit{false};
+    /// Set while the fiber is parked and not in the run queue.
+    std::atomic_bool parked{false};
+};
+
+/// The state of a 🐜, which is kept in a pinned buffer.
+struct FiberState {
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool finished = false;
+    /// Fibers waiting for this fiber to finish.
+    std::vector<Fiber *> joiners;
+};
+
+namespace Fibers {
+    /// The number of safepoints a fiber passes before it yields to other runnable fibers.
+    constexpr unsigned int timeSlice = 1000;
+
+    /// Starts a new fiber that calls @c callable and signals @c state, a pinned buffer containing a FiberState, once
+    /// the callable returned.
+    void spawn(Object *callable, Object *state);
+    /// Lets other fibers run. @c thread must be a fiber.
+    /// @warning GC-invoking
+    void yield(Thread *thread);
+    /// Suspends the fiber until @c unpark() is called for it. Returns immediately if @c unpark() was called since the
+    /// fiber last parked. Callers must check the condition they wait for again, as the fiber may be woken spuriously.
+    /// @warning GC-invoking
+    void park(Thread *thread);
+    /// Makes the parked fiber runnable. Can be called from any thread.
+    void unpark(Fiber *fiber);
+    /// Parks the fiber until @c deadline has passed.
+    /// @warning GC-invoking
+    void sleepUntil(Thread *thread, std::chrono::steady_clock::time_point deadline);
+    /// Parks the fiber until @c descriptor is readable, or writable if @c write is true.
+    /// @warning GC-invoking
+    void waitForDescriptor(Thread *thread, int descriptor, bool write);
+    /// Checks the native stack and yields if the time slice of the fiber is used up.
+    void checkpoint(Thread *thread);
+}  // namespace Fibers
+
+}  // namespace Emojicode
+
+#endif /* Fiber_hpp */
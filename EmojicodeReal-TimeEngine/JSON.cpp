@@ -71,7 +71,7 @@ void parseJSON(Thread *thread, Box *destination) {
             errorExit();
         }
 
-        c = thread->thisObject()->val<String>()->characters()[i++];
+        c = thread->thisObject()->val<String>()->characterAt(i++);
 
         switch (stackCurrent->state) {
             case JSON_STRING:
@@ -105,7 +105,7 @@ void parseJSON(Thread *thread, Box *destination) {
                         appendEscape('r', '\r')
                         appendEscape('t', '\t')
                     case 'u': {
-                        EmojicodeChar *chars = thread->thisObject()->val<String>()->characters();
+                        String *string = thread->thisObject()->val<String>();
                         EmojicodeInteger x = 0, high = 0;
                         while (true) {
                             for (size_t e = i + 4; i < e; i++) {
@@ -113,7 +113,7 @@ void parseJSON(Thread *thread, Box *destination) {
                                     errorExit();
                                 }
 
-                                c = chars[i];
+                                c = string->characterAt(i);
                                 x *= 16;
 
                                 if ('0' <= c && c <= '9') {
@@ -133,7 +133,7 @@ void parseJSON(Thread *thread, Box *destination) {
                                 x = (high << 10) + x + 0x10000 - (0xD800 << 10) - 0xDC00;
                             }
                             else if (0xD800 <= x && x <= 0xDBFF) {
-                                if (i + 2 >= length || chars[i++] != '\\' || chars[i++] != 'u') {
+                                if (i + 2 >= length || string->characterAt(i++) != '\\' || string->characterAt(i++) != 'u') {
                                     errorExit();
                                 }
                                 high = x;
@@ -7,13 +7,16 @@
 //
 
 #include "List.h"
+#include "RadixSort.hpp"
 #include "String.h"
 #include "Thread.hpp"
 #include "standard.h"
 #include <algorithm>
 #include <cstring>
+#include <numeric>
 #include <random>
 #include <utility>
+#include <vector>
 
 namespace Emojicode {
 
@@ -162,6 +165,135 @@ void listSort(Thread *thread) {
     thread->returnFromFunction();
 }
 
+/// The kinds of values that can be sorted without calling back into Emojicode code.
+enum class SortKind {
+    Integer, Double, String
+};
+
+/// Returns the kind of the @c count values in @c boxes or terminates the program with @c message if they are not all
+/// 🚂, all 🚀 or all 🔡.
+SortKind sortKind(const Box *boxes, size_t count, const char *message) {
+    if (count == 0) {
+        return SortKind::Integer;
+    }
+    EmojicodeInteger type = boxes[0].type.raw;
+    if (!std::all_of(boxes, boxes + count, [type](const Box &box) { return box.type.raw == type; })) {
+        error(message);
+    }
+    switch (type) {
+        case T_INTEGER:
+            return SortKind::Integer;
+        case T_DOUBLE:
+            return SortKind::Double;
+        case T_OBJECT:
+            if (std::all_of(boxes, boxes + count, [](const Box &box) { return box.value1.object->klass == CL_STRING; })) {
+                return SortKind::String;
+            }
+            break;
+    }
+    error(message);
+}
+
+/// Sorts the @c count boxes, which must all be of kind @c kind, stably in place.
+void sortBoxes(Box *boxes, size_t count, SortKind kind, bool descending) {
+    uint64_t complement = descending ? ~uint64_t(0) : 0;
+    switch (kind) {
+        case SortKind::Integer:
+            radixSort(boxes, count, [complement](const Box &box) { return sortKey(box.value1.raw) ^ complement; });
+            break;
+        case SortKind::Double:
+            radixSort(boxes, count, [complement](const Box &box) { return sortKey(box.value1.doubl) ^ complement; });
+            break;
+        case SortKind::String:
+            std::stable_sort(boxes, boxes + count, [descending](const Box &a, const Box &b) {
+                auto order = stringCompare(a.value1.object->val<String>(), b.value1.object->val<String>());
+                return descending ? order > 0 : order < 0;
+            });
+            break;
+    }
+}
+
+/// Reorders the list in the this-slot so that the element at @c order[i] becomes the element at @c i.
+void listPermute(Thread *thread, const std::vector<size_t> &order) {
+    auto *list = thread->thisObject()->val<List>();
+    std::vector<Box> elements(order.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        elements[i] = list->elements()[order[i]];
+    }
+    std::copy(elements.begin(), elements.end(), list->elements());
+}
+
+void listSortNatural(Thread *thread) {
+    auto *list = thread->thisObject()->val<List>();
+    SortKind kind = sortKind(list->elements(), list->count, "🐑 can only sort lists of 🚂, 🚀 or 🔡.");
+    sortBoxes(list->elements(), list->count, kind, thread->variable(0).raw);
+    thread->returnFromFunction();
+}
+
+void listSortByKey(Thread *thread) {
+    size_t count = thread->thisObject()->val<List>()->count;
+    if (count < 2) {
+        thread->returnFromFunction();
+        return;
+    }
+
+    // The keys are stored in a list so that the garbage collector finds the strings among them.
+    auto keysObject = thread->retain(newObject(CL_LIST));
+    Object *items = newArray(sizeCalculationWithOverflowProtection(count, sizeof(Box)));
+    keysObject->val<List>()->items = items;
+    keysObject->val<List>()->capacity = count;
+
+    for (size_t i = 0; i < count; i++) {
+        Value args[STORAGE_BOX_VALUE_SIZE];
+        thread->thisObject()->val<List>()->elements()[i].copyTo(args);
+        Box key;
+        executeCallableExtern(thread->variable(0).object, args, sizeof(args), thread, reinterpret_cast<Value *>(&key));
+        if (thread->thisObject()->val<List>()->count != count) {
+            error("The list was modified while 🐏 was computing the keys.");
+        }
+        auto *keys = keysObject->val<List>();
+        keys->elements()[keys->count++] = key;
+    }
+
+    Box *keys = keysObject->val<List>()->elements();
+    SortKind kind = sortKind(keys, count, "The keys by which 🐏 sorts must all be 🚂, all 🚀 or all 🔡.");
+    std::vector<Box> decorated(count);
+    for (size_t i = 0; i < count; i++) {
+        // The index of the element takes the place of the key’s type.
+        decorated[i] = keys[i];
+        decorated[i].type.raw = static_cast<EmojicodeInteger>(i);
+    }
+    sortBoxes(decorated.data(), count, kind, thread->variable(1).raw);
+
+    std::vector<size_t> order(count);
+    std::transform(decorated.begin(), decorated.end(), order.begin(), [](const Box &box) { return box.type.raw; });
+    listPermute(thread, order);
+    thread->release(1);
+    thread->returnFromFunction();
+}
+
+void listSortStable(Thread *thread) {
+    size_t count = thread->thisObject()->val<List>()->count;
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    // Only indices are sorted and the elements are read from the list for every comparison, as the comparator may
+    // cause the garbage collector to move them.
+    std::stable_sort(order.begin(), order.end(), [thread, count](size_t a, size_t b) {
+        Value args[2 * STORAGE_BOX_VALUE_SIZE];
+        auto *list = thread->thisObject()->val<List>();
+        list->elements()[a].copyTo(args);
+        list->elements()[b].copyTo(args + STORAGE_BOX_VALUE_SIZE);
+        Value c;
+        executeCallableExtern(thread->variable(0).object, args, sizeof(args), thread, &c);
+        if (thread->thisObject()->val<List>()->count != count) {
+            error("The list was modified while 🐎 was sorting it.");
+        }
+        return c.raw < 0;
+    });
+    listPermute(thread, order);
+    thread->returnFromFunction();
+}
+
 void listFromListBridge(Thread *thread) {
     auto listO = thread->retain(newObject(CL_LIST));
 
@@ -43,6 +43,9 @@ void listRemoveBridge(Thread *thread);
 void listPopBridge(Thread *thread);
 void listInsertBridge(Thread *thread);
 void listSort(Thread *thread);
+void listSortNatural(Thread *thread);
+void listSortByKey(Thread *thread);
+void listSortStable(Thread *thread);
 void listFromListBridge(Thread *thread);
 void listRemoveAllBridge(Thread *thread);
 void listSetBridge(Thread *thread);
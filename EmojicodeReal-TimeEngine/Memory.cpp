@@ -8,19 +8,28 @@
 
 #include "Memory.hpp"
 #include "Class.hpp"
+#include "Dictionary.h"
 #include "Engine.hpp"
+#include "List.h"
+#include "String.h"
+#include "TaskPool.hpp"
 #include "Thread.hpp"
 #include <algorithm>
+#include <chrono>
 #include <condition_variable>
 #include <cstdlib>
 #include <cstring>
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include <vector>
 
 namespace Emojicode {
 
 std::atomic_size_t memoryUse(0);
+/// Whether memory handed out by allocateObject() must be cleared first. Initially the heap is zeroed by calloc. After
+/// a collection the space is cleared piecemeal by the allocating threads, which keeps the pause proportional to the
+/// live objects rather than to the size of the heap.
 bool zeroingNeeded = false;
 Byte *currentHeap;
 Byte *otherHeap;
@@ -36,63 +45,151 @@ std::mutex garbageCollectionMutex;
 std::condition_variable pauseThreadsCondition;
 std::condition_variable pausingThreadsCountCondition;
 
-inline Object* allocateObject(size_t size, Object **keep = nullptr, Thread *thread = nullptr) {
-    RetainedObjectPointer rop(nullptr);
-    if (pauseThreads) {
-        if (keep != nullptr) {
-            rop = thread->retain(*keep);
+/// The available garbage collectors. The copying collector divides the heap into two semispaces and can use only one
+/// of them at a time. The mark-compact collector uses the whole heap, which makes it preferable if memory is scarce,
+/// but each collection must visit the live objects several times. Selected with EMOJICODE_COLLECTOR.
+enum class Collector {
+    Copying, MarkCompact
+};
+Collector collector = Collector::Copying;
+
+/// Determines what mark() and markValueReference() do with the reference passed.
+enum class GCPhase {
+    /// Copying collector: Copy the object to the current semispace and update the reference.
+    Copy,
+    /// Mark-compact collector: Set the object live and remember it to be scanned.
+    Mark,
+    /// Mark-compact collector: Remember the root, which is updated afterwards.
+    CollectRoots,
+    /// Mark-compact collector: Update the reference to the location of the object after compaction.
+    Update,
+};
+GCPhase gcPhase = GCPhase::Copy;
+
+/// Mark-compact collector: One bit for every alignof(Object) bytes of the heap. The bits of all granules occupied by
+/// a live object are set.
+uint64_t *liveMap;
+/// Mark-compact collector: One bit for every word of liveMap, set if any bit in the word is set.
+uint64_t *liveMapSummary;
+/// Mark-compact collector: For every word of liveMap the number of live bytes before the granules it describes.
+size_t *forwardingBase;
+/// Mark-compact collector: The value of memoryUse when the collection began.
+size_t compactedMemoryUse;
+std::vector<Object *> markStack;
+std::vector<Object **> rootSlots;
+std::vector<Value **> rootValueSlots;
+
+/// The value area of an object of CL_PINNED_BUFFER.
+struct PinnedBuffer {
+    char *bytes;
+    void (*finalizer)(char *bytes);
+};
+/// All objects of CL_PINNED_BUFFER, whose buffers have not been freed yet.
+std::vector<Object *> pinnedBuffers;
+std::mutex pinnedBuffersMutex;
+/// The number of bytes allocated for pinned buffers since the last collection. A collection is triggered once this
+/// exceeds gcThreshold, as otherwise a program that allocates little on the heap could accumulate unreachable buffers
+/// without bound.
+std::atomic_size_t pinnedMemoryGrowth(0);
+
+inline bool pinnedMemoryPressure() {
+    return pinnedMemoryGrowth.load(std::memory_order_relaxed) > gcThreshold;
+}
+
+/// Whether the duration of each pause is recorded and reported on exit. Enabled with EMOJICODE_GC_STATISTICS.
+bool gcStatistics = false;
+std::vector<std::chrono::duration<double, std::milli>> pauseTimes;
+/// The time it took all threads to reach a safepoint in each pause.
+std::vector<std::chrono::duration<double, std::milli>> timesToSafepoint;
+
+/// Allocates a memory block of @c size bytes.
+inline Byte* allocateObject(size_t size, Object **keep = nullptr, Thread *thread = nullptr) {
+    while (true) {
+        RetainedObjectPointer rop(nullptr);
+        if (pauseThreads) {
+            if (keep != nullptr) {
+                rop = thread->retain(*keep);
+            }
+            performPauseForGC();
+            if (keep != nullptr) {
+                *keep = rop.unretainedPointer();
+                thread->release(1);
+            }
         }
-        performPauseForGC();
-        if (keep != nullptr) {
-            *keep = rop.unretainedPointer();
-            thread->release(1);
+
+        // memoryUse must never exceed the memory actually handed out, even temporarily, as otherwise a concurrent
+        // allocation could be placed behind the end of the heap after the excess is given back.
+        size_t index = memoryUse.load();
+        while (index + size <= gcThreshold && !pinnedMemoryPressure()) {
+            if (memoryUse.compare_exchange_weak(index, index + size)) {
+                if (zeroingNeeded) {
+                    std::memset(currentHeap + index, 0, size);
+                }
+                return currentHeap + index;
+            }
         }
-    }
 
-    size_t index;
-    if ((index = memoryUse.fetch_add(size)) + size > gcThreshold) {
-        memoryUse -= size;
         if (keep != nullptr) {
             rop = thread->retain(*keep);
         }
         std::unique_lock<std::mutex> lock(garbageCollectionMutex, std::try_to_lock);
         if (lock.owns_lock()) {  // OK, this thread is now the garbage collector
-            gc(lock, size);
+            // Collect unless another thread has just done so.
+            if (memoryUse + size > gcThreshold || pinnedMemoryPressure()) {
+                gc(lock, size);
+            }
         }
         else {  // This thread also detected it’s time for garbage collection but lost the race...
-            while (!pauseThreads);
-            performPauseForGC();
+            // ...the collection might also be over already, in which case the allocation is simply retried.
+            pauseForGC();
         }
         if (keep != nullptr) {
             *keep = rop.unretainedPointer();
             thread->release(1);
         }
-        return allocateObject(size);
     }
-    return reinterpret_cast<Object *>(currentHeap + index);
 }
 
 inline bool inCurrentHeap(Object *o) {
     return currentHeap <= reinterpret_cast<Byte *>(o) && reinterpret_cast<Byte *>(o) < currentHeap + heapSize / 2;
 }
 
-Object* resizeObject(Object *ptr, size_t newSize, Thread *thread) {
-//    auto expectation = reinterpret_cast<size_t>(ptr) - reinterpret_cast<size_t>(currentHeap);
-//    size_t index = memoryUse;
-//    if (index + newSize <= gcThreshold && memoryUse.compare_exchange_weak(expectation, index + newSize)) {
-//        // memoryUse equaled the expectation, therefore no allocation has happend in the meantime, index still
-//        // represented the value of memory use and it was leigtimate to replace memoryUse’s value with index + newSize
-//        return ptr;
-//    }
+/// The word in front of the header of an array stores the size of the array with this bit set. The blocks of all other
+/// objects begin with the class pointer, which is aligned, which allows a heap walk to distinguish them.
+const size_t arraySizeTag = 1;
+
+inline size_t& arraySizeWord(Object *array) {
+    return reinterpret_cast<size_t *>(array)[-1];
+}
+
+/// Returns the number of bytes the object occupies, including all headers.
+inline size_t objectSize(Object *object) {
+    if (object->klass == CL_ARRAY) {
+        return arraySizeWord(object) & ~arraySizeTag;
+    }
+    return object->klass->size;
+}
+
+size_t arraySize(Object *array) {
+    return objectSize(array) - sizeof(size_t) - sizeof(Object);
+}
 
-    Object *block = allocateObject(newSize, &ptr, thread);
-    std::memcpy(block, ptr, ptr->size);
-    return block;
+/// Returns the address at which the memory block occupied by the object begins.
+inline Byte* objectBlock(Object *object) {
+    auto byte = reinterpret_cast<Byte *>(object);
+    return object->klass == CL_ARRAY ? byte - sizeof(size_t) : byte;
+}
+
+/// Returns the object that occupies the memory block beginning at @c block.
+inline Object* blockObject(Byte *block) {
+    if (*reinterpret_cast<size_t *>(block) & arraySizeTag) {
+        return reinterpret_cast<Object *>(block + sizeof(size_t));
+    }
+    return reinterpret_cast<Object *>(block);
 }
 
 Object* newObject(Class *klass) {
-    Object *object = allocateObject(klass->size);
-    object->size = klass->size;
+    auto *object = reinterpret_cast<Object *>(allocateObject(klass->size));
     object->klass = klass;
     return object;
 }
@@ -106,43 +203,219 @@ size_t sizeCalculationWithOverflowProtection(size_t items, size_t itemSize) {
     return r;
 }
 
-Object* newArray(size_t size) {
-    size_t fullSize = alignSize(sizeof(Object) + size);
-    Object *object = allocateObject(fullSize);
-    object->size = fullSize;
+/// Allocates the block for an array of the given full size and initializes its headers.
+inline Object* allocateArray(size_t fullSize, Object **keep = nullptr, Thread *thread = nullptr) {
+    Byte *block = allocateObject(fullSize, keep, thread);
+    *reinterpret_cast<size_t *>(block) = fullSize | arraySizeTag;
+    auto *object = reinterpret_cast<Object *>(block + sizeof(size_t));
     object->klass = CL_ARRAY;
     return object;
 }
 
+Object* newArray(size_t size) {
+    return allocateArray(alignSize(sizeof(size_t) + sizeof(Object) + size));
+}
+
 Object* resizeArray(Object *array, size_t size, Thread *thread) {
-    size_t fullSize = alignSize(sizeof(Object) + size);
-    Object *object = resizeObject(array, fullSize, thread);
-    object->size = fullSize;
+    size_t fullSize = alignSize(sizeof(size_t) + sizeof(Object) + size);
+    Object *object = allocateArray(fullSize, &array, thread);
+    std::memcpy(object + 1, array + 1, std::min(objectSize(array), fullSize) - sizeof(size_t) - sizeof(Object));
     return object;
 }
 
+Object* newPinnedBuffer(size_t size, void (*finalizer)(char *bytes)) {
+    auto *bytes = static_cast<char *>(std::malloc(std::max<size_t>(size, 1)));
+    if (bytes == nullptr) {
+        error("Cannot allocate pinned buffer of %zu bytes.", size);
+    }
+    Object *buffer = newObject(CL_PINNED_BUFFER);
+    buffer->val<PinnedBuffer>()->bytes = bytes;
+    buffer->val<PinnedBuffer>()->finalizer = finalizer;
+    pinnedMemoryGrowth += size;
+
+    std::lock_guard<std::mutex> lock(pinnedBuffersMutex);
+    pinnedBuffers.push_back(buffer);
+    return buffer;
+}
+
+char* pinnedBufferBytes(Object *buffer) {
+    return buffer->val<PinnedBuffer>()->bytes;
+}
+
+/// Sorts @c durations and prints their mean, p50, p99 and max.
+void printDurations(std::vector<std::chrono::duration<double, std::milli>> &durations) {
+    std::sort(durations.begin(), durations.end());
+    std::chrono::duration<double, std::milli> total(0);
+    for (auto time : durations) {
+        total += time;
+    }
+    auto percentile = [&durations](double p) {
+        return durations[std::min(durations.size() - 1, static_cast<size_t>(p * durations.size()))].count();
+    };
+    fprintf(stderr, "mean %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms\n", total.count() / durations.size(),
+            percentile(0.5), percentile(0.99), durations.back().count());
+}
+
+void printGCStatistics() {
+    if (pauseTimes.empty()) {
+        fprintf(stderr, "GC: No collections.\n");
+        return;
+    }
+    fprintf(stderr, "GC: %zu collections, pause ", pauseTimes.size());
+    printDurations(pauseTimes);
+    fprintf(stderr, "GC: time to safepoint ");
+    printDurations(timesToSafepoint);
+}
+
 void allocateHeap() {
+    if (const char *name = getenv("EMOJICODE_COLLECTOR")) {
+        if (std::strcmp(name, "markcompact") == 0) {
+            collector = Collector::MarkCompact;
+        }
+        else if (std::strcmp(name, "copying") != 0) {
+            error("Unknown collector %s. Use copying or markcompact.", name);
+        }
+    }
+
     currentHeap = static_cast<Byte *>(calloc(heapSize, 1));
     if (!currentHeap) {
         error("Cannot allocate heap!");
     }
-    otherHeap = currentHeap + (heapSize / 2);
+
+    if (collector == Collector::MarkCompact) {
+        gcThreshold = heapSize;
+        gcPhase = GCPhase::Mark;
+        size_t liveMapWords = heapSize / alignof(Object) / 64 + 1;
+        liveMap = static_cast<uint64_t *>(calloc(liveMapWords, sizeof(uint64_t)));
+        liveMapSummary = static_cast<uint64_t *>(calloc(liveMapWords / 64 + 1, sizeof(uint64_t)));
+        forwardingBase = static_cast<size_t *>(calloc(liveMapWords, sizeof(size_t)));
+        if (!liveMap || !liveMapSummary || !forwardingBase) {
+            error("Cannot allocate heap!");
+        }
+    }
+    else {
+        otherHeap = currentHeap + (heapSize / 2);
+    }
+
+    CL_PINNED_BUFFER->size = alignSize(sizeof(Object) + sizeof(PinnedBuffer));
+
+    if (getenv("EMOJICODE_GC_STATISTICS") != nullptr) {
+        gcStatistics = true;
+        atexit(printGCStatistics);
+    }
+}
+
+Object* findObjectContaining(Byte *heap, Byte *address) {
+    for (Byte *byte = heap;;) {
+        Object *object = blockObject(byte);
+        // The copying collector might have replaced the class pointer with a forwarding pointer already.
+        byte += objectSize(inCurrentHeap(object->newLocation) ? object->newLocation : object);
+        if (address < byte) {
+            return object;
+        }
+    }
+}
+
+// MARK: Mark-Compact Collector
+
+inline size_t granuleIndex(const void *address) {
+    return (static_cast<const Byte *>(address) - currentHeap) / alignof(Object);
+}
+
+inline bool isMarked(Object *object) {
+    auto granule = granuleIndex(object);
+    return liveMap[granule / 64] & (UINT64_C(1) << (granule % 64));
+}
+
+/// Sets the bits of all granules occupied by the object.
+void setLive(Object *object) {
+    size_t granule = granuleIndex(objectBlock(object));
+    size_t end = granule + objectSize(object) / alignof(Object);
+    while (granule < end) {
+        size_t bit = granule % 64;
+        size_t count = std::min<size_t>(64 - bit, end - granule);
+        uint64_t bits = count == 64 ? ~UINT64_C(0) : (UINT64_C(1) << count) - 1;
+        liveMap[granule / 64] |= bits << bit;
+        liveMapSummary[granule / 64 / 64] |= UINT64_C(1) << (granule / 64 % 64);
+        granule += count;
+    }
+}
+
+/// Returns the address to which the given address, which must lie within a live object, is moved by the compaction.
+/// This is the number of live bytes before the address, calculated from forwardingBase and the bits of liveMap.
+inline Byte* forwardingAddress(Byte *address) {
+    auto granule = granuleIndex(address);
+    auto before = liveMap[granule / 64] & ((UINT64_C(1) << (granule % 64)) - 1);
+    return currentHeap + forwardingBase[granule / 64] + __builtin_popcountll(before) * alignof(Object) +
+        (address - currentHeap) % alignof(Object);
+}
+
+inline bool inCompactedRange(const void *address) {
+    return currentHeap <= address && address < currentHeap + compactedMemoryUse;
+}
+
+/// Copying collector: Copies the object to the end of the current semispace and leaves a forwarding pointer behind.
+inline Object* copyObject(Object *oldObject) {
+    Byte *block = objectBlock(oldObject);
+    size_t size = objectSize(oldObject);
+    Byte *newBlock = currentHeap + memoryUse;
+    memoryUse += size;
+    std::memcpy(newBlock, block, size);
+    auto *newObject = reinterpret_cast<Object *>(newBlock + (reinterpret_cast<Byte *>(oldObject) - block));
+    oldObject->newLocation = newObject;
+    return newObject;
+}
+
+/// Returns the array in which the built-in container @c object stores its contents or @c nullptr.
+///
+/// The copying collector copies this array immediately behind its owner. As the owner’s marker then copies the
+/// contents in order, each of which is again followed by its own array, a container, its storage and its elements end
+/// up adjacent to each other instead of being scattered by the breadth-first scan.
+inline Object* ownedArray(Object *object) {
+    if (object->klass == CL_STRING) {
+        return object->val<String>()->charactersObject;
+    }
+    if (object->klass == CL_LIST) {
+        return object->val<List>()->items;
+    }
+    if (object->klass == CL_DICTIONARY) {
+        return object->val<EmojicodeDictionary>()->table;
+    }
+    return nullptr;
 }
 
 void mark(Object **oPointer) {
+    switch (gcPhase) {
+        case GCPhase::Copy:
+            break;
+        case GCPhase::Mark:
+            if (!isMarked(*oPointer)) {
+                setLive(*oPointer);
+                markStack.push_back(*oPointer);
+            }
+            return;
+        case GCPhase::CollectRoots:
+            rootSlots.push_back(oPointer);
+            return;
+        case GCPhase::Update:
+            *oPointer = reinterpret_cast<Object *>(forwardingAddress(reinterpret_cast<Byte *>(*oPointer)));
+            return;
+    }
+
     Object *oldObject = *oPointer;
     if (inCurrentHeap(oldObject->newLocation)) {
         *oPointer = oldObject->newLocation;
         return;
     }
 
-    auto *newObject = reinterpret_cast<Object *>(currentHeap + memoryUse);
-    memoryUse += oldObject->size;
-
-    std::memcpy(newObject, oldObject, oldObject->size);
-
-    oldObject->newLocation = newObject;
+    Object *newObject = copyObject(oldObject);
     *oPointer = newObject;
+
+    // The reference to the array is updated as usual when the owner is scanned and finds the forwarding pointer.
+    Object *array = ownedArray(newObject);
+    if (array != nullptr && !inCurrentHeap(array->newLocation)) {
+        copyObject(array);
+    }
 }
 
 inline bool inOldHeap(Value *o) {
@@ -150,83 +423,225 @@ inline bool inOldHeap(Value *o) {
 }
 
 void markValueReference(Value **valuePointer) {
-    if (!inOldHeap(*valuePointer)) {
-        return;
-    }
     auto b = reinterpret_cast<Byte *>(*valuePointer);
-
-    Byte *byte = otherHeap;
-    while (true) {
-        auto object = reinterpret_cast<Object *>(byte);
-        if (b < byte + object->size) {
-            auto offset = b - byte;
+    switch (gcPhase) {
+        case GCPhase::Copy: {
+            if (!inOldHeap(*valuePointer)) {
+                return;
+            }
+            auto object = findObjectContaining(otherHeap, b);
+            auto offset = b - reinterpret_cast<Byte *>(object);
             mark(&object);
             *valuePointer = reinterpret_cast<Value *>(reinterpret_cast<Byte *>(object) + offset);
             return;
         }
-        byte += object->size;
+        case GCPhase::Mark:
+            if (inCompactedRange(b)) {
+                auto object = findObjectContaining(currentHeap, b);
+                mark(&object);
+            }
+            return;
+        case GCPhase::CollectRoots:
+            rootValueSlots.push_back(valuePointer);
+            return;
+        case GCPhase::Update:
+            if (inCompactedRange(b)) {
+                *valuePointer = reinterpret_cast<Value *>(forwardingAddress(b));
+            }
+            return;
     }
 }
 
-void gc(std::unique_lock<std::mutex> &garbageCollectionLock, size_t minSpace) {
-    pauseThreads = true;
-    if (minSpace > gcThreshold) {
-        error("Allocation of %zu bytes is too big. Try to enlarge the heap. (Heap size: %zu)", minSpace, heapSize);
+void markRoots() {
+    for (Thread *thread = ThreadsManager::anyThread(); thread != nullptr; thread = ThreadsManager::nextThread(thread)) {
+        thread->markStack();
+        thread->markRetainList();
     }
 
-    auto pausingThreadsCountLock = std::unique_lock<std::mutex>(pausingThreadsCountMutex);
-    pausingThreadsCount++;
+    for (uint_fast16_t i = 0; i < stringPoolCount; i++) {
+        mark(stringPool + i);
+    }
 
-    pausingThreadsCountCondition.wait(pausingThreadsCountLock, []{
-        return pausingThreadsCount == ThreadsManager::threadsCount();
-    });
+    TaskPool::markTasks();
+}
 
-    std::swap(currentHeap, otherHeap);
+/// Marks all objects referenced by @c object.
+void scanObject(Object *object) {
+    Class *klass = object->klass;
+    Value *variables = object->variableDestination(0);
+    for (uint64_t bits = klass->referenceBitmap; bits != 0; bits &= bits - 1) {
+        Object *&reference = variables[__builtin_ctzll(bits)].object;
+        if (reference != nullptr) {
+            mark(&reference);
+        }
+    }
+    for (size_t i = 0; i < klass->conditionalRecordsCount; i++) {
+        markByObjectVariableRecord(klass->conditionalRecords[i], variables, i);
+    }
 
-    size_t oldMemoryUse = memoryUse;
+    if (klass->mark != nullptr) {
+        klass->mark(object);
+    }
+}
+
+/// Frees the buffers of all unreachable objects of CL_PINNED_BUFFER and updates pinnedBuffers with the new locations
+/// of the others. Must be called after all live objects were marked and, if the mark-compact collector is used, the
+/// forwarding addresses are known but before the objects are moved.
+void sweepPinnedBuffers() {
+    size_t kept = 0;
+    for (Object *buffer : pinnedBuffers) {
+        bool live = collector == Collector::MarkCompact ? isMarked(buffer) : inCurrentHeap(buffer->newLocation);
+        if (!live) {
+            auto pinnedBuffer = buffer->val<PinnedBuffer>();
+            if (pinnedBuffer->finalizer != nullptr) {
+                pinnedBuffer->finalizer(pinnedBuffer->bytes);
+            }
+            std::free(pinnedBuffer->bytes);
+            continue;
+        }
+        pinnedBuffers[kept++] = collector == Collector::MarkCompact ?
+            reinterpret_cast<Object *>(forwardingAddress(reinterpret_cast<Byte *>(buffer))) : buffer->newLocation;
+    }
+    pinnedBuffers.resize(kept);
+    pinnedMemoryGrowth = 0;
+}
+
+/// Copies all live objects into the other semispace, which becomes the current one.
+void copyLiveObjects() {
+    std::swap(currentHeap, otherHeap);
     memoryUse = 0;
 
-    std::lock_guard<std::mutex> threadListLock(ThreadsManager::threadListMutex);
-    for (Thread *thread = ThreadsManager::anyThread(); thread != nullptr; thread = ThreadsManager::nextThread(thread)) {
-        thread->markStack();
-        thread->markRetainList();
+    markRoots();
+
+    for (Byte *byte = currentHeap; byte < currentHeap + memoryUse;) {
+        Object *object = blockObject(byte);
+        scanObject(object);
+        byte += objectSize(object);
     }
 
-    for (uint_fast16_t i = 0; i < stringPoolCount; i++) {
-        mark(stringPool + i);
+    sweepPinnedBuffers();
+}
+
+/// Calls @c body with the index of every word of liveMap with a bit set in ascending order.
+template <typename F>
+inline void forEachLiveMapWord(F body) {
+    size_t summaryWords = compactedMemoryUse / alignof(Object) / 64 / 64 + 1;
+    for (size_t i = 0; i < summaryWords; i++) {
+        for (uint64_t bits = liveMapSummary[i]; bits != 0; bits &= bits - 1) {
+            body(i * 64 + __builtin_ctzll(bits));
+        }
     }
+}
 
-    for (Byte *byte = currentHeap; byte < currentHeap + memoryUse;) {
-        auto object = reinterpret_cast<Object *>(byte);
+/// Slides all live objects to the beginning of the heap, preserving their order.
+void compactLiveObjects() {
+    compactedMemoryUse = memoryUse;
+
+    gcPhase = GCPhase::Mark;
+    markRoots();
+    while (!markStack.empty()) {
+        Object *object = markStack.back();
+        markStack.pop_back();
+        scanObject(object);
+    }
+
+    size_t liveMemory = 0;
+    forEachLiveMapWord([&liveMemory](size_t i) {
+        forwardingBase[i] = liveMemory;
+        liveMemory += __builtin_popcountll(liveMap[i]) * alignof(Object);
+    });
+    sweepPinnedBuffers();
 
-        for (size_t i = 0; i < object->klass->instanceVariableRecordsCount; i++) {
-            auto record = object->klass->instanceVariableRecords[i];
-            markByObjectVariableRecord(record, object->variableDestination(0), i);
+    // An object is never moved beyond its own end, so the headers of the objects not yet visited stay intact.
+    size_t nextGranule = 0;
+    forEachLiveMapWord([&nextGranule](size_t i) {
+        if (nextGranule >= (i + 1) * 64) {
+            return;  // This word is entirely covered by the last object moved.
         }
+        uint64_t bits = liveMap[i];
+        if (nextGranule > i * 64) {
+            bits &= ~UINT64_C(0) << (nextGranule % 64);
+        }
+        while (bits != 0) {
+            Byte *byte = currentHeap + (i * 64 + __builtin_ctzll(bits)) * alignof(Object);
+            size_t size = objectSize(blockObject(byte));
+            std::memmove(forwardingAddress(byte), byte, size);
+            nextGranule = granuleIndex(byte + size);
+            bits = nextGranule >= (i + 1) * 64 ? 0 : bits & (~UINT64_C(0) << (nextGranule % 64));
+        }
+    });
 
-        if (object->klass->mark != nullptr) {
-            object->klass->mark(object);
+    // A root might be visited more than once, but must only be updated once.
+    gcPhase = GCPhase::CollectRoots;
+    markRoots();
+    std::sort(rootSlots.begin(), rootSlots.end());
+    rootSlots.erase(std::unique(rootSlots.begin(), rootSlots.end()), rootSlots.end());
+    std::sort(rootValueSlots.begin(), rootValueSlots.end());
+    rootValueSlots.erase(std::unique(rootValueSlots.begin(), rootValueSlots.end()), rootValueSlots.end());
+
+    gcPhase = GCPhase::Update;
+    for (auto slot : rootSlots) {
+        if (inCompactedRange(*slot)) {
+            mark(slot);
         }
-        byte += object->size;
     }
+    for (auto slot : rootValueSlots) {
+        markValueReference(slot);
+    }
+    rootSlots.clear();
+    rootValueSlots.clear();
 
-    if (oldMemoryUse == memoryUse) {
-        error("Terminating program due to too high memory pressure.");
+    memoryUse = liveMemory;
+    for (Byte *byte = currentHeap; byte < currentHeap + memoryUse;) {
+        Object *object = blockObject(byte);
+        scanObject(object);
+        byte += objectSize(object);
+    }
+
+    forEachLiveMapWord([](size_t i) { liveMap[i] = 0; });
+    std::memset(liveMapSummary, 0, (compactedMemoryUse / alignof(Object) / 64 / 64 + 1) * sizeof(uint64_t));
+    gcPhase = GCPhase::Mark;
+}
+
+void gc(std::unique_lock<std::mutex> &garbageCollectionLock, size_t minSpace) {
+    auto pauseStart = std::chrono::steady_clock::now();
+    pauseThreads = true;
+    if (minSpace > gcThreshold) {
+        error("Allocation of %zu bytes is too big. Try to enlarge the heap. (Heap size: %zu)", minSpace, heapSize);
     }
 
-//    std::memset(otherHeap, 0xAA, heapSize / 2);
+    auto pausingThreadsCountLock = std::unique_lock<std::mutex>(pausingThreadsCountMutex);
+    pausingThreadsCount++;
 
-    if (zeroingNeeded) {
-        std::memset(currentHeap + memoryUse, 0, (heapSize / 2) - memoryUse);
+    pausingThreadsCountCondition.wait(pausingThreadsCountLock, []{
+        return pausingThreadsCount == ThreadsManager::threadsCount();
+    });
+    if (gcStatistics) {
+        timesToSafepoint.emplace_back(std::chrono::steady_clock::now() - pauseStart);
+    }
+
+    std::lock_guard<std::mutex> threadListLock(ThreadsManager::threadListMutex);
+    if (collector == Collector::MarkCompact) {
+        compactLiveObjects();
     }
     else {
-        zeroingNeeded = true;
+        copyLiveObjects();
     }
 
+    if (memoryUse + minSpace > gcThreshold) {
+        error("Terminating program due to too high memory pressure.");
+    }
+
+    zeroingNeeded = true;
+
     pausingThreadsCount--;
     pausingThreadsCountLock.unlock();
     pauseThreads = false;
 
+    if (gcStatistics) {
+        pauseTimes.emplace_back(std::chrono::steady_clock::now() - pauseStart);
+    }
+
     garbageCollectionLock.unlock();
     pauseThreadsCondition.notify_all();
 }
@@ -245,6 +660,11 @@ inline void performPauseForGC() {
     pausingThreadsCount--;
 }
 
+void threadTerminated() {
+    std::lock_guard<std::mutex> pausingThreadsCountLock(pausingThreadsCountMutex);
+    pausingThreadsCountCondition.notify_one();
+}
+
 void allowGC() {
     std::unique_lock<std::mutex> pausingThreadsCountLock(pausingThreadsCountMutex);
     pausingThreadsCount++;
@@ -10,6 +10,7 @@
 #define Object_hpp
 
 #include "Engine.hpp"
+#include <atomic>
 
 namespace Emojicode {
 
@@ -18,9 +19,12 @@ namespace Emojicode {
 #endif
 
 inline size_t alignSize(size_t size) {
-    return size + (size % alignof(Object));
+    return (size + alignof(Object) - 1) & ~(alignof(Object) - 1);
 }
 
+/// Returns the size of the value area of @c array, which may be slightly larger than the size it was created with.
+size_t arraySize(Object *array);
+
 /// This method is called during the initialization of the Engine.
 /// @warning Obviously, you should not call it anywhere else!
 void allocateHeap();
@@ -29,6 +33,21 @@ void allocateHeap();
 /// @warning You should normally not call this method.
 inline void performPauseForGC();
 
+/// Must be called after a thread was removed from the thread list. The garbage collector might be waiting for that
+/// thread to pause.
+void threadTerminated();
+
+/// Set while the garbage collector waits for all threads to pause.
+extern std::atomic_bool pauseThreads;
+
+/// Safepoint poll: Pauses the calling thread if the garbage collector is waiting for it. In the common case this is a
+/// single load, which makes it cheap enough to be performed on every backward branch.
+inline void pollForGC() {
+    if (pauseThreads.load(std::memory_order_relaxed)) {
+        pauseForGC();
+    }
+}
+
 template <typename T>
 inline void markByObjectVariableRecord(ObjectVariableRecord &record, Value *va, T &index) {
     switch (record.type) {
@@ -0,0 +1,357 @@
+//
+//  PrimitiveArray.cpp
+//  Emojicode
+//
+
+#include "PrimitiveArray.hpp"
+#include "List.h"
+#include "RadixSort.hpp"
+#include "Thread.hpp"
+#include "standard.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <numeric>
+
+namespace Emojicode {
+
+/// Converts between the elements of a primitive array and the values with which Emojicode code passes them.
+template <typename Element>
+struct ElementConversion {
+    /// The type in which the elements are summed up.
+    using Sum = Element;
+    static Element fromValue(Value value) { return value.raw; }
+    static Value toValue(Element element) { return element; }
+};
+
+template <>
+struct ElementConversion<double> {
+    using Sum = double;
+    static double fromValue(Value value) { return value.doubl; }
+    static Value toValue(double element) { return element; }
+};
+
+/// Bytes are passed as 🚂. Only the lowest eight bits of an integer are stored.
+template <>
+struct ElementConversion<uint8_t> {
+    using Sum = EmojicodeInteger;
+    static uint8_t fromValue(Value value) { return static_cast<uint8_t>(value.raw); }
+    static Value toValue(uint8_t element) { return EmojicodeInteger(element); }
+};
+
+template <typename Element>
+Element* arrayElements(PrimitiveArray *array) {
+    return array->elementsObject->val<Element>();
+}
+
+void primitiveArrayMark(Object *self) {
+    auto *array = self->val<PrimitiveArray>();
+    if (array->elementsObject) {
+        mark(&array->elementsObject);
+    }
+}
+
+/// Ensures that the array in the this-slot has room for @c count elements and returns it.
+/// @warning GC-invoking
+template <typename Element>
+PrimitiveArray* primitiveArrayReserve(Thread *thread, size_t count) {
+    auto *array = thread->thisObject()->val<PrimitiveArray>();
+    if (count <= array->capacity) {
+        return array;
+    }
+
+    size_t capacity = std::max(std::max(array->capacity * 2, count), size_t(8));
+    size_t size = sizeCalculationWithOverflowProtection(capacity, sizeof(Element));
+    Object *elements;
+    if (array->elementsObject == nullptr) {
+        elements = newArray(size);
+    }
+    else {
+        elements = resizeArray(array->elementsObject, size, thread);
+    }
+    array = thread->thisObject()->val<PrimitiveArray>();
+    array->elementsObject = elements;
+    array->capacity = capacity;
+    return array;
+}
+
+/// Makes a negative @c index relative to the end of an array of @c count elements. Returns false if the index is out of
+/// range afterwards.
+bool primitiveArrayIndex(size_t count, EmojicodeInteger *index) {
+    if (*index < 0) {
+        *index += count;
+    }
+    return 0 <= *index && static_cast<size_t>(*index) < count;
+}
+
+/// Limits the range of @c length elements starting at @c from to the @c count elements of an array.
+void primitiveArrayRange(size_t count, EmojicodeInteger *from, EmojicodeInteger *length) {
+    auto icount = static_cast<EmojicodeInteger>(count);
+    *from = std::min(std::max(*from, EmojicodeInteger(0)), icount);
+    *length = std::min(std::max(*length, EmojicodeInteger(0)), icount - *from);
+}
+
+template <typename Element>
+void PrimitiveArrayBridges<Element>::init(Thread *thread) {
+    // The Real-Time Engine guarantees pre-nulled objects.
+    thread->returnFromFunction(thread->thisContext());
+}
+
+template <typename Element>
+void PrimitiveArrayBridges<Element>::initWithCapacity(Thread *thread) {
+    EmojicodeInteger capacity = thread->variable(0).raw;
+    if (capacity > 0) {
+        primitiveArrayReserve<Element>(thread, capacity);
+    }
+    thread->returnFromFunction(thread->thisContext());
+}
+
+template <typename Element>
+void PrimitiveArrayBridges<Element>::initFilled(Thread *thread) {
+    EmojicodeInteger count = thread->variable(0).raw;
+    if (count > 0) {
+        auto *array = primitiveArrayReserve<Element>(thread, count);
+        std::fill_n(arrayElements<Element>(array), count, ElementConversion<Element>::fromValue(thread->variable(1)));
+        array->count = count;
+    }
+    thread->returnFromFunction(thread->thisContext());
+}
+
+template <typename Element>
+void PrimitiveArrayBridges<Element>::initFromList(Thread *thread) {
+    size_t count = thread->variable(0).object->val<List>()->count;
+    if (count > 0) {
+        auto *array = primitiveArrayReserve<Element>(thread, count);
+        auto *list = thread->variable(0).object->val<List>();
+        std::transform(list->elements(), list->elements() + count, arrayElements<Element>(array), [](const Box &box) {
+            return ElementConversion<Element>::fromValue(box.value1);
+        });
+        array->count = count;
+    }
+    thread->returnFromFunction(thread->thisContext());
+}
+
+template <typename Element>
+void PrimitiveArrayBridges<Element>::count(Thread *thread) {
+    thread->returnFromFunction(static_cast<EmojicodeInteger>(thread->thisObject()->val<PrimitiveArray>()->count));
+}
+
+template <typename Element>
+void PrimitiveArrayBridges<Element>::get(Thread *thread) {
+    auto *array = thread->thisObject()->val<PrimitiveArray>();
+    EmojicodeInteger index = thread->variable(0).raw;
+    if (!primitiveArrayIndex(array->count, &index)) {
+        thread->returnNothingnessFromFunction();
+        return;
+    }
+    thread->returnOEValueFromFunction(ElementConversion<Element>::toValue(arrayElements<Element>(array)[index]));
+}
+
+template <typename Element>
+void PrimitiveArrayBridges<Element>::set(Thread *thread) {
+    EmojicodeInteger index = thread->variable(0).raw;
+    auto *array = thread->thisObject()->val<PrimitiveArray>();
+    if (index < 0) {
+        index += array->count;
+        if (index < 0) {
+            thread->returnFromFunction();
+            return;
+        }
+    }
+    if (array->count <= static_cast<size_t>(index)) {
+        array = primitiveArrayReserve<Element>(thread, index + 1);
+        std::fill(arrayElements<Element>(array) + array->count, arrayElements<Element>(array) + index, Element(0));
+        array->count = index + 1;
+    }
+    arrayElements<Element>(array)[index] = ElementConversion<Element>::fromValue(thread->variable(1));
+    thread->returnFromFunction();
+}
+
+template <typename Element>
+void PrimitiveArrayBridges<Element>::append(Thread *thread) {
+    auto *array = thread->thisObject()->val<PrimitiveArray>();
+    array = primitiveArrayReserve<Element>(thread, array->count + 1);
+    arrayElements<Element>(array)[array->count++] = ElementConversion<Element>::fromValue(thread->variable(0));
+    thread->returnFromFunction();
+}
+
+template <typename Element>
+void PrimitiveArrayBridges<Element>::removeAll(Thread *thread) {
+    thread->thisObject()->val<PrimitiveArray>()->count = 0;
+    thread->returnFromFunction();
+}
+
+template <typename Element>
+void PrimitiveArrayBridges<Element>::fill(Thread *thread) {
+    auto *array = thread->thisObject()->val<PrimitiveArray>();
+    EmojicodeInteger from = thread->variable(1).raw;
+    EmojicodeInteger length = thread->variable(2).raw;
+    primitiveArrayRange(array->count, &from, &length);
+    if (length > 0) {
+        std::fill_n(arrayElements<Element>(array) + from, length,
+                    ElementConversion<Element>::fromValue(thread->variable(0)));
+    }
+    thread->returnFromFunction();
+}
+
+template <typename Element>
+void PrimitiveArrayBridges<Element>::copy(Thread *thread) {
+    auto *array = thread->thisObject()->val<PrimitiveArray>();
+    auto *source = thread->variable(0).object->val<PrimitiveArray>();
+    EmojicodeInteger from = thread->variable(1).raw;
+    EmojicodeInteger length = thread->variable(2).raw;
+    EmojicodeInteger index = thread->variable(3).raw;
+    primitiveArrayRange(source->count, &from, &length);
+    if (index < 0 || array->count < static_cast<size_t>(index) || length == 0) {
+        thread->returnFromFunction();
+        return;
+    }
+
+    array = primitiveArrayReserve<Element>(thread, index + length);
+    source = thread->variable(0).object->val<PrimitiveArray>();
+    // The source may be this array.
+    std::memmove(arrayElements<Element>(array) + index, arrayElements<Element>(source) + from,
+                 length * sizeof(Element));
+    array->count = std::max(array->count, static_cast<size_t>(index + length));
+    thread->returnFromFunction();
+}
+
+template <typename Element>
+void PrimitiveArrayBridges<Element>::slice(Thread *thread) {
+    auto sliceObject = thread->retain(newObject(thread->thisObject()->klass));
+    auto *array = thread->thisObject()->val<PrimitiveArray>();
+    EmojicodeInteger from = thread->variable(0).raw;
+    EmojicodeInteger length = thread->variable(1).raw;
+    primitiveArrayRange(array->count, &from, &length);
+
+    if (length > 0) {
+        Object *elements = newArray(length * sizeof(Element));
+        array = thread->thisObject()->val<PrimitiveArray>();
+        std::memcpy(elements->val<Element>(), arrayElements<Element>(array) + from, length * sizeof(Element));
+        auto *slice = sliceObject->val<PrimitiveArray>();
+        slice->elementsObject = elements;
+        slice->count = length;
+        slice->capacity = length;
+    }
+    thread->release(1);
+    thread->returnFromFunction(sliceObject.unretainedPointer());
+}
+
+template <typename Element>
+void PrimitiveArrayBridges<Element>::sum(Thread *thread) {
+    auto *array = thread->thisObject()->val<PrimitiveArray>();
+    using Sum = typename ElementConversion<Element>::Sum;
+    Sum sum = 0;
+    if (array->count > 0) {
+        sum = std::accumulate(arrayElements<Element>(array), arrayElements<Element>(array) + array->count, Sum(0));
+    }
+    thread->returnFromFunction(sum);
+}
+
+template <typename Element>
+void PrimitiveArrayBridges<Element>::minimum(Thread *thread) {
+    auto *array = thread->thisObject()->val<PrimitiveArray>();
+    if (array->count == 0) {
+        thread->returnNothingnessFromFunction();
+        return;
+    }
+    Element *elements = arrayElements<Element>(array);
+    Element minimum = elements[0];
+    for (size_t i = 1; i < array->count; i++) {
+        minimum = std::min(minimum, elements[i]);
+    }
+    thread->returnOEValueFromFunction(ElementConversion<Element>::toValue(minimum));
+}
+
+template <typename Element>
+void PrimitiveArrayBridges<Element>::maximum(Thread *thread) {
+    auto *array = thread->thisObject()->val<PrimitiveArray>();
+    if (array->count == 0) {
+        thread->returnNothingnessFromFunction();
+        return;
+    }
+    Element *elements = arrayElements<Element>(array);
+    Element maximum = elements[0];
+    for (size_t i = 1; i < array->count; i++) {
+        maximum = std::max(maximum, elements[i]);
+    }
+    thread->returnOEValueFromFunction(ElementConversion<Element>::toValue(maximum));
+}
+
+template <typename Element>
+void PrimitiveArrayBridges<Element>::indexOf(Thread *thread) {
+    auto *array = thread->thisObject()->val<PrimitiveArray>();
+    if (array->count == 0) {
+        thread->returnNothingnessFromFunction();
+        return;
+    }
+    Element *elements = arrayElements<Element>(array);
+    Element *found = std::find(elements, elements + array->count,
+                               ElementConversion<Element>::fromValue(thread->variable(0)));
+    if (found == elements + array->count) {
+        thread->returnNothingnessFromFunction();
+        return;
+    }
+    thread->returnOEValueFromFunction(static_cast<EmojicodeInteger>(found - elements));
+}
+
+template <typename Element>
+void sortElements(Element *elements, size_t count, bool descending) {
+    uint64_t complement = descending ? ~uint64_t(0) : 0;
+    radixSort(elements, count, [complement](Element element) { return sortKey(element) ^ complement; });
+}
+
+/// Bytes are sorted by counting them.
+template <>
+void sortElements(uint8_t *elements, size_t count, bool descending) {
+    std::array<size_t, 256> counts{};
+    for (size_t i = 0; i < count; i++) {
+        counts[elements[i]]++;
+    }
+    for (size_t i = 0; i < 256; i++) {
+        size_t byte = descending ? 255 - i : i;
+        elements = std::fill_n(elements, counts[byte], static_cast<uint8_t>(byte));
+    }
+}
+
+template <typename Element>
+void PrimitiveArrayBridges<Element>::sort(Thread *thread) {
+    auto *array = thread->thisObject()->val<PrimitiveArray>();
+    if (array->count > 1) {
+        sortElements(arrayElements<Element>(array), array->count, thread->variable(0).raw);
+    }
+    thread->returnFromFunction();
+}
+
+template struct PrimitiveArrayBridges<EmojicodeInteger>;
+template struct PrimitiveArrayBridges<double>;
+template struct PrimitiveArrayBridges<uint8_t>;
+
+void byteArrayInitFromData(Thread *thread) {
+    EmojicodeInteger length = thread->variable(0).object->val<Data>()->length;
+    if (length > 0) {
+        auto *array = primitiveArrayReserve<uint8_t>(thread, length);
+        std::memcpy(arrayElements<uint8_t>(array), thread->variable(0).object->val<Data>()->bytes, length);
+        array->count = length;
+    }
+    thread->returnFromFunction(thread->thisContext());
+}
+
+void byteArrayToData(Thread *thread) {
+    size_t count = thread->thisObject()->val<PrimitiveArray>()->count;
+    auto bytesObject = thread->retain(newArray(count));
+    auto *array = thread->thisObject()->val<PrimitiveArray>();
+    if (count > 0) {
+        std::memcpy(bytesObject->val<char>(), arrayElements<uint8_t>(array), count);
+    }
+
+    Object *o = newObject(CL_DATA);
+    auto *d = o->val<Data>();
+    d->length = count;
+    d->bytesObject = bytesObject.unretainedPointer();
+    d->bytes = d->bytesObject->val<char>();
+    thread->release(1);
+    thread->returnFromFunction(o);
+}
+
+}  // namespace Emojicode
@@ -0,0 +1,65 @@
+//
+//  PrimitiveArray.hpp
+//  Emojicode
+//
+
+#ifndef PrimitiveArray_hpp
+#define PrimitiveArray_hpp
+
+#include "EmojicodeAPI.hpp"
+#include <cstdint>
+
+namespace Emojicode {
+
+/// The structure of 📊, 📈 and 💾, which store 🚂, 🚀 and bytes respectively. Unlike the elements of a 🍨, the elements
+/// are not boxed but stored one after another, which makes the array a fourth of the size of an equivalent list and
+/// allows the bulk operations to be vectorized.
+struct PrimitiveArray {
+    /// The number of elements in the array.
+    size_t count;
+    /// The number of elements for which @c elementsObject has room.
+    size_t capacity;
+    /// The array that stores the elements. It does not contain any object pointers. Can be @c nullptr if @c capacity
+    /// is 0.
+    Object *elementsObject;
+};
+
+void primitiveArrayMark(Object *self);
+
+/// The natives of a primitive array storing elements of type @c Element. They are instantiated for
+/// @c EmojicodeInteger (📊), @c double (📈) and @c uint8_t (💾).
+template <typename Element>
+struct PrimitiveArrayBridges {
+    static void init(Thread *thread);
+    static void initWithCapacity(Thread *thread);
+    static void initFilled(Thread *thread);
+    static void initFromList(Thread *thread);
+    static void count(Thread *thread);
+    static void get(Thread *thread);
+    static void set(Thread *thread);
+    static void append(Thread *thread);
+    static void removeAll(Thread *thread);
+    static void fill(Thread *thread);
+    static void copy(Thread *thread);
+    static void slice(Thread *thread);
+    static void sum(Thread *thread);
+    static void minimum(Thread *thread);
+    static void maximum(Thread *thread);
+    static void indexOf(Thread *thread);
+    static void sort(Thread *thread);
+};
+
+extern template struct PrimitiveArrayBridges<EmojicodeInteger>;
+extern template struct PrimitiveArrayBridges<double>;
+extern template struct PrimitiveArrayBridges<uint8_t>;
+
+using IntegerArrayBridges = PrimitiveArrayBridges<EmojicodeInteger>;
+using DoubleArrayBridges = PrimitiveArrayBridges<double>;
+using ByteArrayBridges = PrimitiveArrayBridges<uint8_t>;
+
+void byteArrayInitFromData(Thread *thread);
+void byteArrayToData(Thread *thread);
+
+}  // namespace Emojicode
+
+#endif /* PrimitiveArray_hpp */
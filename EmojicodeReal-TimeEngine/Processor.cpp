@@ -10,9 +10,12 @@
 #include "../EmojicodeInstructions.h"
 #include "Class.hpp"
 #include "Dictionary.h"
+#include "Fiber.hpp"
 #include "List.h"
+#include "Memory.hpp"
 #include "String.h"
 #include "Thread.hpp"
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <functional>
@@ -20,8 +23,17 @@
 
 namespace Emojicode {
 
+/// Called at calls and backward branches. Pauses the thread if the garbage collector requests it and lets a fiber
+/// yield once its time slice is used up.
+inline void safepoint(Thread *thread) {
+    pollForGC();
+    if (thread->fiber() != nullptr) {
+        Fibers::checkpoint(thread);
+    }
+}
+
 inline void runFunctionPointerBlock(Thread *thread) {
-    pauseForGC();
+    safepoint(thread);
 
     while (thread->currentStackFrame()->executionPointer) {
         Box garbage;
@@ -674,6 +686,7 @@ void produce(Thread *thread, Value *destination) {
             dictionaryInit(dico->val<EmojicodeDictionary>());
 
             EmojicodeInstruction variableSlot = thread->consumeInstruction();
+            dictionaryReserve(dico, thread->consumeInstruction());
             EmojicodeInstruction *end = thread->currentStackFrame()->executionPointer + thread->consumeInstruction();
             while (thread->currentStackFrame()->executionPointer < end) {
                 Value key;
@@ -706,20 +719,40 @@ void produce(Thread *thread, Value *destination) {
 
             size_t bufferSize = 10;
             size_t length = 0;
-            auto characters = thread->retain(newArray(bufferSize * sizeof(EmojicodeChar)));
+            // The characters are stored compactly until a string that is not compact is appended.
+            bool compact = true;
+            auto characters = thread->retain(newArray(bufferSize * sizeof(uint8_t)));
 
             for (EmojicodeInstruction i = 0; i < stringCount; i++) {
                 Value v;
                 produce(thread, &v);
                 auto stringObject = thread->retain(v.object);
-                if (bufferSize - length < stringObject->val<String>()->length) {
-                    bufferSize += static_cast<size_t>(stringObject->val<String>()->length) - (bufferSize - length);
-                    characters = resizeArray(characters.unretainedPointer(), bufferSize * sizeof(EmojicodeChar), thread);
+                size_t stringLength = stringObject->val<String>()->length;
+                if (compact && !stringObject->val<String>()->compact && stringLength > 0) {
+                    bufferSize = std::max(bufferSize, length + stringLength);
+                    Object *wide = newArray(bufferSize * sizeof(EmojicodeChar));
+                    std::copy(characters->val<uint8_t>(), characters->val<uint8_t>() + length,
+                              wide->val<EmojicodeChar>());
+                    characters = wide;
+                    compact = false;
+                }
+                else if (bufferSize - length < stringLength) {
+                    bufferSize += stringLength - (bufferSize - length);
+                    characters = resizeArray(characters.unretainedPointer(),
+                                             bufferSize * (compact ? sizeof(uint8_t) : sizeof(EmojicodeChar)), thread);
                 }
-                EmojicodeChar *dest = characters->val<EmojicodeChar>() + length;
                 auto string = stringObject->val<String>();
-                std::memcpy(dest, string->characters(), string->length * sizeof(EmojicodeChar));
-                length += stringObject->val<String>()->length;
+                withCharacters(string, [&](auto stringCharacters) {
+                    if (compact) {
+                        std::copy(stringCharacters, stringCharacters + stringLength,
+                                  characters->val<uint8_t>() + length);
+                    }
+                    else {
+                        std::copy(stringCharacters, stringCharacters + stringLength,
+                                  characters->val<EmojicodeChar>() + length);
+                    }
+                });
+                length += stringLength;
                 thread->release(1);
             }
 
@@ -727,6 +760,7 @@ void produce(Thread *thread, Value *destination) {
             auto *string = object->val<String>();
             string->length = length;
             string->charactersObject = characters.unretainedPointer();
+            string->compact = compact;
 
             destination->object = object;
             thread->release(1);
@@ -810,6 +844,7 @@ void produce(Thread *thread, Value *destination) {
             if (sth.raw) {
                 auto a = thread->consumeInstruction();
                 thread->currentStackFrame()->executionPointer -= a;
+                safepoint(thread);
             }
             else {
                 thread->consumeInstruction();
@@ -832,6 +867,7 @@ void produce(Thread *thread, Value *destination) {
             produce(thread, &sth);
             if (!sth.raw) {
                 thread->currentStackFrame()->executionPointer -= thread->consumeInstruction();
+                safepoint(thread);
             }
             else {
                 thread->consumeInstruction();
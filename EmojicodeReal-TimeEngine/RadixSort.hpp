@@ -0,0 +1,89 @@
+//
+//  RadixSort.hpp
+//  Emojicode
+//
+
+#ifndef RadixSort_hpp
+#define RadixSort_hpp
+
+#include "EmojicodeAPI.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Emojicode {
+
+constexpr uint64_t sortKeySignBit = uint64_t(1) << 63;
+
+/// Returns an unsigned key that orders like @c integer.
+inline uint64_t sortKey(EmojicodeInteger integer) {
+    return static_cast<uint64_t>(integer) ^ sortKeySignBit;
+}
+
+/// Returns an unsigned key that orders like @c doubl. Negative zero comes before zero and NaNs are placed at the ends.
+inline uint64_t sortKey(double doubl) {
+    uint64_t bits;
+    std::memcpy(&bits, &doubl, sizeof(bits));
+    return (bits & sortKeySignBit) != 0 ? ~bits : bits | sortKeySignBit;
+}
+
+/// The inverse of @c sortKey(EmojicodeInteger).
+inline EmojicodeInteger integerFromSortKey(uint64_t key) {
+    return static_cast<EmojicodeInteger>(key ^ sortKeySignBit);
+}
+
+/// The inverse of @c sortKey(double).
+inline double doubleFromSortKey(uint64_t key) {
+    uint64_t bits = (key & sortKeySignBit) != 0 ? key ^ sortKeySignBit : ~key;
+    double doubl;
+    std::memcpy(&doubl, &bits, sizeof(doubl));
+    return doubl;
+}
+
+/// Sorts the @c count items stably in the ascending order of the 64-bit keys returned by @c key. This is a least
+/// significant digit radix sort with eight passes of eight bits, of which passes in which all items have the same digit
+/// are skipped.
+template <typename Item, typename Key>
+void radixSort(Item *items, size_t count, Key key) {
+    if (count < 2) {
+        return;
+    }
+
+    std::vector<size_t> histograms(8 * 256);
+    for (size_t i = 0; i < count; i++) {
+        uint64_t k = key(items[i]);
+        for (size_t digit = 0; digit < 8; digit++) {
+            histograms[digit * 256 + ((k >> (digit * 8)) & 0xFF)]++;
+        }
+    }
+
+    std::vector<Item> buffer(count);
+    Item *from = items;
+    Item *to = buffer.data();
+    for (size_t digit = 0; digit < 8; digit++) {
+        size_t *histogram = histograms.data() + digit * 256;
+        unsigned int shift = digit * 8;
+        if (histogram[(key(from[0]) >> shift) & 0xFF] == count) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < 256; bucket++) {
+            size_t bucketCount = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketCount;
+        }
+        for (size_t i = 0; i < count; i++) {
+            to[histogram[(key(from[i]) >> shift) & 0xFF]++] = from[i];
+        }
+        std::swap(from, to);
+    }
+    if (from != items) {
+        std::copy(from, from + count, items);
+    }
+}
+
+}  // namespace Emojicode
+
+#endif /* RadixSort_hpp */
@@ -11,9 +11,11 @@
 #include "Engine.hpp"
 #include "String.h"
 #include "Memory.hpp"
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <dlfcn.h>
+#include <vector>
 
 #ifdef DEBUG
 #define DEBUG_LOG(format, ...) printf(format "\n", ##__VA_ARGS__)
@@ -248,6 +250,7 @@ void readPackage(FILE *in) {
             klass->instanceVariableRecords[i].condition = readUInt16(in);
             klass->instanceVariableRecords[i].type = static_cast<ObjectVariableType>(readUInt16(in));
         }
+        klass->prepareReferenceBitmap();
 
         DEBUG_LOG("Read %d object variable records", klass->instanceVariableRecordsCount);
     }
@@ -287,6 +290,7 @@ Function* readBytecode(FILE *in) {
     CL_DATA = classTable[2];
     CL_DICTIONARY = classTable[3];
     CL_CLOSURE = classTable[4];
+    CL_DICTIONARY_ENUMERATOR = classTable[5];
 
     DEBUG_LOG("✅ Read all packages");
 
@@ -302,15 +306,25 @@ Function* readBytecode(FILE *in) {
     stringPoolCount = readUInt16(in);
     DEBUG_LOG("Reading string pool with %d strings", stringPoolCount);
     stringPool = new Object*[stringPoolCount];
+    std::vector<EmojicodeChar> characters;
     for (int i = 0; i < stringPoolCount; i++) {
         Object *o = newObject(CL_STRING);
         auto *string = o->val<String>();
 
         string->length = readUInt16(in);
-        string->charactersObject = newArray(string->length * sizeof(EmojicodeChar));
+        characters.resize(string->length);
+        for (auto &character : characters) {
+            character = readEmojicodeChar(in);
+        }
 
-        for (int j = 0; j < string->length; j++) {
-            string->characters()[j] = readEmojicodeChar(in);
+        string->compact = charactersFitCompact(characters.data(), characters.size());
+        if (string->compact) {
+            string->charactersObject = newArray(string->length * sizeof(uint8_t));
+            std::copy(characters.begin(), characters.end(), string->compactCharacters());
+        }
+        else {
+            string->charactersObject = newArray(string->length * sizeof(EmojicodeChar));
+            std::copy(characters.begin(), characters.end(), string->characters());
         }
 
         stringPool[i] = o;
@@ -9,16 +9,30 @@
 #include "String.h"
 #include "../utf8.h"
 #include "List.h"
+#include "Memory.hpp"
+#include "StringKernels.hpp"
 #include "Thread.hpp"
 #include "standard.h"
 #include <algorithm>
 #include <cctype>
 #include <cmath>
 #include <cstring>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace Emojicode {
 
+/// Calls @c function with pointers to the characters of @c a and @c b as provided by @c withCharacters().
+template <typename Function>
+inline auto withCharacters(String *a, String *b, Function function) {
+    return withCharacters(a, [b, &function](auto aCharacters) {
+        return withCharacters(b, [aCharacters, &function](auto bCharacters) {
+            return function(aCharacters, bCharacters);
+        });
+    });
+}
+
 EmojicodeInteger stringCompare(String *a, String *b) {
     if (a == b) {
         return 0;
@@ -27,11 +41,114 @@ EmojicodeInteger stringCompare(String *a, String *b) {
         return a->length - b->length;
     }
 
-    return std::memcmp(a->characters(), b->characters(), a->length * sizeof(EmojicodeChar));
+    return withCharacters(a, b, [length = a->length](auto aCharacters, auto bCharacters) {
+        auto mismatch = std::mismatch(aCharacters, aCharacters + length, bCharacters);
+        if (mismatch.first == aCharacters + length) {
+            return EmojicodeInteger(0);
+        }
+        return EmojicodeInteger(*mismatch.first) - EmojicodeInteger(*mismatch.second);
+    });
 }
 
 bool stringEqual(String *a, String *b) {
-    return stringCompare(a, b) == 0;
+    if (a->hash != 0 && b->hash != 0 && a->hash != b->hash) {
+        return false;
+    }
+    if (a->length != b->length) {
+        return false;
+    }
+    return withCharacters(a, b, [length = a->length](auto aCharacters, auto bCharacters) {
+        return std::equal(aCharacters, aCharacters + length, bCharacters);
+    });
+}
+
+inline uint64_t rotateLeft(uint64_t x, int bits) {
+    return (x << bits) | (x >> (64 - bits));
+}
+
+/// The finalizer of MurmurHash3, which lets every bit of @c x affect every bit of the result.
+inline uint64_t mixHash(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/// Two characters are hashed at a time. The words are assembled from the characters so that a compact string has the
+/// same hash as a string with the same characters that is not compact.
+template <typename Character>
+uint64_t hashCharacters(const Character *characters, size_t length) {
+    uint64_t hash = 0x9e3779b97f4a7c15ULL ^ length;
+    size_t i = 0;
+    for (; i + 2 <= length; i += 2) {
+        uint64_t word = uint64_t(characters[i]) | uint64_t(characters[i + 1]) << 32;
+        hash = rotateLeft(hash ^ (word * 0x87c37b91114253d5ULL), 31) * 0x4cf5ad432745937fULL;
+    }
+    if (i < length) {
+        hash = rotateLeft(hash ^ (characters[i] * 0x87c37b91114253d5ULL), 31) * 0x4cf5ad432745937fULL;
+    }
+    return mixHash(hash);
+}
+
+uint64_t stringHash(String *string) {
+    if (string->hash != 0) {
+        return string->hash;
+    }
+
+    uint64_t hash = withCharacters(string, [length = static_cast<size_t>(string->length)](auto characters) {
+        return hashCharacters(characters, length);
+    });
+    if (hash == 0) {
+        hash = 1;
+    }
+    string->hash = hash;
+    return hash;
+}
+
+bool charactersFitCompact(const EmojicodeChar *characters, size_t count) {
+    return std::all_of(characters, characters + count, [](EmojicodeChar c) { return c <= compactCharacterMax; });
+}
+
+Object* newString(EmojicodeInteger length, bool compact, Thread *thread) {
+    if (length == 0) {
+        return emptyString;
+    }
+
+    auto co = thread->retain(newArray(length * (compact ? sizeof(uint8_t) : sizeof(EmojicodeChar))));
+    Object *stringObject = newObject(CL_STRING);
+    auto *string = stringObject->val<String>();
+    string->length = length;
+    string->charactersObject = co.unretainedPointer();
+    string->compact = compact;
+    thread->release(1);
+    return stringObject;
+}
+
+void copyCharacters(String *destination, EmojicodeInteger offset, String *source, EmojicodeInteger from,
+                    EmojicodeInteger count) {
+    withCharacters(source, [&](auto characters) {
+        if (destination->compact) {
+            std::copy(characters + from, characters + from + count, destination->compactCharacters() + offset);
+        }
+        else {
+            std::copy(characters + from, characters + from + count, destination->characters() + offset);
+        }
+    });
+}
+
+/// A substring shares the characters of the string it was taken from only if it has at least
+/// @c substringSharingMinimum characters and at least 1/@c substringSharingFraction of the characters object, which
+/// may be much larger than the string if that is itself a substring. Otherwise it is copied, so that a small substring
+/// does not keep a large string alive.
+const EmojicodeInteger substringSharingMinimum = 32;
+const EmojicodeInteger substringSharingFraction = 4;
+
+/// Returns the number of characters the characters object of @c string has room for.
+EmojicodeInteger charactersObjectLength(String *string) {
+    size_t size = arraySize(string->charactersObject);
+    return static_cast<EmojicodeInteger>(string->compact ? size : size / sizeof(EmojicodeChar));
 }
 
 /** @warning GC-invoking */
@@ -49,34 +166,177 @@ Object* stringSubstring(EmojicodeInteger from, EmojicodeInteger length, Thread *
     if (length == 0) {
         return emptyString;
     }
+    if (length == string->length) {
+        return thread->thisObject();
+    }
 
-    auto co = thread->retain(newArray(length * sizeof(EmojicodeChar)));
+    if (length >= substringSharingMinimum &&
+        length >= charactersObjectLength(string) / substringSharingFraction) {
+        Object *ostro = newObject(CL_STRING);
+        string = thread->thisObject()->val<String>();
+        auto *ostr = ostro->val<String>();
+        ostr->length = length;
+        ostr->charactersObject = string->charactersObject;
+        ostr->offset = string->offset + from;
+        ostr->compact = string->compact;
+        return ostro;
+    }
 
-    Object *ostro = newObject(CL_STRING);
-    auto *ostr = ostro->val<String>();
+    bool compact = string->compact || charactersFitCompact(string->characters() + from, length);
+    Object *ostro = newString(length, compact, thread);
+    copyCharacters(ostro->val<String>(), 0, thread->thisObject()->val<String>(), from, length);
+    return ostro;
+}
+
+/// Returns the number of bytes needed to encode the characters of @c string in UTF8.
+size_t utf8Size(String *string) {
+    if (string->compact) {
+        auto characters = string->compactCharacters();
+        return string->length + std::count_if(characters, characters + string->length, [](uint8_t c) {
+            return c >= 0x80;
+        });
+    }
+    return u8_codingsize(string->characters(), string->length);
+}
 
-    ostr->length = length;
-    ostr->charactersObject = co.unretainedPointer();
+/// Encodes the characters of @c string as UTF8 into @c utf8, which must provide room for @c size bytes, and returns
+/// the number of bytes written.
+size_t encodeUTF8(String *string, char *utf8, size_t size) {
+    if (!string->compact) {
+        return u8_toutf8(utf8, size, string->characters(), string->length);
+    }
+    char *byte = utf8;
+    auto characters = string->compactCharacters();
+    for (EmojicodeInteger i = 0; i < string->length; i++) {
+        size_t ascii = u8_asciispan(reinterpret_cast<const char *>(characters + i), string->length - i);
+        std::memcpy(byte, characters + i, ascii);
+        byte += ascii;
+        i += ascii;
+        if (i == string->length) {
+            break;
+        }
+        uint8_t c = characters[i];
+        *byte++ = static_cast<char>(0xC0 | (c >> 6));
+        *byte++ = static_cast<char>(0x80 | (c & 0x3F));
+    }
+    return byte - utf8;
+}
 
-    std::memcpy(ostr->characters(), thread->thisObject()->val<String>()->characters() + from,
-                length * sizeof(EmojicodeChar));
+void measureUTF8(const char *utf8, size_t size, EmojicodeInteger *length, bool *compact) {
+    unsigned char maxByte;
+    *length = static_cast<EmojicodeInteger>(u8_measure(utf8, size, &maxByte));
+    // All sequences that encode characters above 0xFF start with a byte of at least 0xC4.
+    *compact = maxByte < 0xC4;
+}
 
-    thread->release(1);
-    return ostro;
+void decodeUTF8(String *string, const char *utf8, size_t size) {
+    if (!string->compact) {
+        u8_toucs(string->characters(), string->length, utf8, size);
+        return;
+    }
+    auto characters = string->compactCharacters();
+    for (size_t i = 0; i < size; i++) {
+        size_t ascii = u8_asciispan(utf8 + i, size - i);
+        std::memcpy(characters, utf8 + i, ascii);
+        characters += ascii;
+        i += ascii;
+        if (i == size) {
+            break;
+        }
+        auto byte = static_cast<uint8_t>(utf8[i]);
+        if (byte >= 0xC0) {
+            uint8_t c = (byte & 0x1F) << 6;
+            if (i + 1 < size && (static_cast<uint8_t>(utf8[i + 1]) & 0xC0) == 0x80) {
+                c |= static_cast<uint8_t>(utf8[++i]) & 0x3F;
+            }
+            *characters++ = c;
+        }
+    }
+}
+
+Object* stringFromUTF8(const char *utf8, size_t size, Thread *thread) {
+    EmojicodeInteger length;
+    bool compact;
+    measureUTF8(utf8, size, &length, &compact);
+    Object *stringObject = newString(length, compact, thread);
+    decodeUTF8(stringObject->val<String>(), utf8, size);
+    return stringObject;
+}
+
+EmojicodeInteger integerCharacterCount(EmojicodeInteger n, EmojicodeInteger base) {
+    EmojicodeInteger d = n < 0 ? 2 : 1;
+    while (n /= base) {
+        d++;
+    }
+    return d;
+}
+
+void writeInteger(EmojicodeInteger n, EmojicodeInteger base, uint8_t *end) {
+    EmojicodeInteger a = std::abs(n);
+    uint8_t *characters = end;
+    do {
+        *--characters =  "0123456789abcdefghijklmnopqrstuvxyz"[a % base % 35];
+    } while (a /= base);
+
+    if (n < 0) {
+        characters[-1] = '-';
+    }
+}
+
+EmojicodeInteger doubleCharacterCount(double d, EmojicodeInteger precision) {
+    double absD = std::abs(d);
+    EmojicodeInteger length = d < 0 ? 1 : 0;
+    if (precision != 0) {
+        length++;
+    }
+    length += precision;
+    EmojicodeInteger iLength = 1;
+    for (size_t i = 1; pow(10, i) < absD; i++) {
+        iLength++;
+    }
+    return length + iLength;
+}
+
+void writeDouble(double d, EmojicodeInteger precision, uint8_t *end) {
+    double absD = std::abs(d);
+    uint8_t *characters = end;
+
+    for (size_t i = precision; i > 0; i--) {
+        *--characters = static_cast<unsigned char>(fmod(absD * pow(10, i), 10.0)) % 10 + '0';
+    }
+
+    if (precision != 0) {
+        *--characters = '.';
+    }
+
+    EmojicodeInteger iLength = 1;
+    for (size_t i = 1; pow(10, i) < absD; i++) {
+        iLength++;
+    }
+    for (size_t i = 0; i < iLength; i++) {
+        *--characters =  static_cast<unsigned char>(fmod(absD / pow(10, i), 10.0)) % 10 + '0';
+    }
+
+    if (d < 0) {
+        characters[-1] = '-';
+    }
 }
 
 const char* stringToCString(Object *str) {
     auto string = str->val<String>();
-    size_t ds = u8_codingsize(string->characters(), string->length);
+    size_t ds = utf8Size(string);
     auto *utf8str = newArray(ds + 1)->val<char>();
     // Convert
-    size_t written = u8_toutf8(utf8str, ds, string->characters(), string->length);
+    size_t written = encodeUTF8(string, utf8str, ds);
     utf8str[written] = 0;
     return utf8str;
 }
 
 Object* stringFromChar(const char *cstring) {
-    EmojicodeInteger len = u8_strlen(cstring);
+    size_t size = strlen(cstring);
+    EmojicodeInteger len;
+    bool compact;
+    measureUTF8(cstring, size, &len, &compact);
 
     if (len == 0) {
         return emptyString;
@@ -85,9 +345,10 @@ Object* stringFromChar(const char *cstring) {
     Object *stro = newObject(CL_STRING);
     auto *string = stro->val<String>();
     string->length = len;
-    string->charactersObject = newArray(len * sizeof(EmojicodeChar));
+    string->compact = compact;
+    string->charactersObject = newArray(len * (compact ? sizeof(uint8_t) : sizeof(EmojicodeChar)));
 
-    u8_toucs(string->characters(), len, cstring, strlen(cstring));
+    decodeUTF8(string, cstring, size);
 
     return stro;
 }
@@ -118,19 +379,41 @@ void stringSubstringBridge(Thread *thread) {
     thread->returnFromFunction(stringSubstring(from, length, thread));
 }
 
+/// Searches for @c needle in @c characters. The string kernels are used if both store their characters the same way.
+template <typename Character, typename NeedleCharacter>
+size_t searchCharacters(const Character *characters, size_t count, const NeedleCharacter *needle,
+                        size_t needleCount) {
+    return std::search(characters, characters + count, needle, needle + needleCount) - characters;
+}
+
+inline size_t searchCharacters(const uint8_t *characters, size_t count, const uint8_t *needle, size_t needleCount) {
+    return StringKernels::search(characters, count, needle, needleCount);
+}
+
+inline size_t searchCharacters(const EmojicodeChar *characters, size_t count, const EmojicodeChar *needle,
+                               size_t needleCount) {
+    return StringKernels::search(characters, count, needle, needleCount);
+}
+
+/// Returns the index of the first occurrence of @c search in @c string at or after @c from, or the length of
+/// @c string if there is none.
+EmojicodeInteger stringFind(String *string, String *search, EmojicodeInteger from) {
+    return from + withCharacters(string, search, [string, search, from](auto characters, auto needle) {
+        return static_cast<EmojicodeInteger>(searchCharacters(characters + from, string->length - from, needle,
+                                                              search->length));
+    });
+}
+
 void stringIndexOf(Thread *thread) {
     auto *string = thread->thisObject()->val<String>();
     auto *search = thread->variable(0).object->val<String>();
 
-    auto last = string->characters() + string->length;
-    EmojicodeChar *location = std::search(string->characters(), last, search->characters(),
-                                          search->characters() + search->length);
-
-    if (location == last) {
+    EmojicodeInteger index = stringFind(string, search, 0);
+    if (index == string->length) {
         thread->returnNothingnessFromFunction();
     }
     else {
-        thread->returnOEValueFromFunction(static_cast<EmojicodeInteger>(location - string->characters()));
+        thread->returnOEValueFromFunction(index);
     }
 }
 
@@ -140,11 +423,11 @@ void stringTrimBridge(Thread *thread) {
     EmojicodeInteger start = 0;
     EmojicodeInteger stop = string->length - 1;
 
-    while (start < string->length && isWhitespace(string->characters()[start])) {
+    while (start < string->length && isWhitespace(string->characterAt(start))) {
         start++;
     }
 
-    while (stop > 0 && isWhitespace(string->characters()[stop])) {
+    while (stop > 0 && isWhitespace(string->characterAt(stop))) {
         stop--;
     }
 
@@ -155,81 +438,59 @@ void stringGetInput(Thread *thread) {
     printf("%s\n", stringToCString(thread->variable(0).object));
     fflush(stdout);
 
-    int bufferSize = 50, oldBufferSize = 0;
-    Object *buffer = newArray(bufferSize);
-    size_t bufferUsedSize = 0;
-
-    while (true) {
-        fgets(buffer->val<char>() + oldBufferSize, bufferSize - oldBufferSize, stdin);
-
-        bufferUsedSize = strlen(buffer->val<char>());
-
-        if (bufferUsedSize < bufferSize - 1) {
-            if (buffer->val<char>()[bufferUsedSize - 1] == '\n') {
-                bufferUsedSize -= 1;
+    std::string line;
+    {
+        BlockingRegion region;
+        char buffer[256];
+        while (fgets(buffer, sizeof(buffer), stdin) != nullptr) {
+            line.append(buffer);
+            if (line.back() == '\n') {
+                line.pop_back();
+                break;
             }
-            break;
         }
-
-        oldBufferSize = bufferSize - 1;
-        bufferSize *= 2;
-        buffer = resizeArray(buffer, bufferSize, thread);
     }
 
-    EmojicodeInteger len = u8_strlen_l(buffer->val<char>(), bufferUsedSize);
+    EmojicodeInteger len;
+    bool compact;
+    measureUTF8(line.data(), line.size(), &len, &compact);
 
+    Object *chars = newArray(len * (compact ? sizeof(uint8_t) : sizeof(EmojicodeChar)));
     auto *string = thread->thisObject()->val<String>();
     string->length = len;
-
-    Object *chars = newArray(len * sizeof(EmojicodeChar));
-    string = thread->thisObject()->val<String>();
     string->charactersObject = chars;
+    string->compact = compact;
 
-    u8_toucs(string->characters(), len, buffer->val<char>(), bufferUsedSize);
+    decodeUTF8(string, line.data(), line.size());
     thread->returnFromFunction(thread->thisContext());
 }
 
+/// Appends the substring of the string in the this-slot from @c from to @c to to @c list.
+/// @warning GC-invoking
+void listAppendSubstring(RetainedObjectPointer list, EmojicodeInteger from, EmojicodeInteger to, Thread *thread) {
+    auto substring = thread->retain(stringSubstring(from, to - from, thread));
+    Box *destination = listAppendDestination(list, thread);
+    destination->copySingleValue(T_OBJECT, substring.unretainedPointer());
+    thread->release(1);
+}
+
 void stringSplitByStringBridge(Thread *thread) {
     auto listObject = thread->retain(newObject(CL_LIST));
 
-    EmojicodeInteger firstOfSeperator = 0, seperatorIndex = 0, firstAfterSeperator = 0;
-
-    for (EmojicodeInteger i = 0, l = thread->thisObject()->val<String>()->length; i < l; i++) {
-        Object *stringObject = thread->thisObject();
-        Object *separator = thread->variable(0).object;
-        if (stringObject->val<String>()->characters()[i] == separator->val<String>()->characters()[seperatorIndex]) {
-            if (seperatorIndex == 0) {
-                firstOfSeperator = i;
-            }
-
-            // Full seperator found
-            if (firstOfSeperator + separator->val<String>()->length == i + 1) {
-                Object *stro;
-                if (firstAfterSeperator == firstOfSeperator) {
-                    stro = emptyString;
-                }
-                else {
-                    stro = stringSubstring(firstAfterSeperator,
-                                           i - firstAfterSeperator - separator->val<String>()->length + 1, thread);
-                }
-                listAppendDestination(listObject, thread)->copySingleValue(T_OBJECT, stro);
-                seperatorIndex = 0;
-                firstAfterSeperator = i + 1;
-            }
-            else {
-                seperatorIndex++;
+    EmojicodeInteger from = 0;
+    EmojicodeInteger separatorLength = thread->variable(0).object->val<String>()->length;
+    if (separatorLength > 0) {
+        while (true) {
+            auto *string = thread->thisObject()->val<String>();
+            EmojicodeInteger index = stringFind(string, thread->variable(0).object->val<String>(), from);
+            if (index == string->length) {
+                break;
             }
-        }
-        else if (seperatorIndex > 0) {  // and not matching
-            seperatorIndex = 0;
-            // We search from the begin of the last partial match
-            i = firstOfSeperator;
+            listAppendSubstring(listObject, from, index, thread);
+            from = index + separatorLength;
         }
     }
-
-    Object *stringObject = thread->thisObject();
-    auto *string = stringObject->val<String>();
-    listAppendDestination(listObject, thread)->copySingleValue(T_OBJECT, stringSubstring(firstAfterSeperator, string->length - firstAfterSeperator, thread));
+    listAppendSubstring(listObject, from, thread->thisObject()->val<String>()->length, thread);
 
     thread->release(1);
     thread->returnFromFunction(listObject.unretainedPointer());
@@ -241,25 +502,26 @@ void stringLengthBridge(Thread *thread) {
 
 void stringUTF8LengthBridge(Thread *thread) {
     auto *str = thread->thisObject()->val<String>();
-    thread->returnFromFunction(static_cast<EmojicodeInteger>(u8_codingsize(str->characters(), str->length)));
+    thread->returnFromFunction(static_cast<EmojicodeInteger>(utf8Size(str)));
 }
 
 void stringByAppendingSymbolBridge(Thread *thread) {
     auto *string = thread->thisObject()->val<String>();
-    auto co = thread->retain(newArray((string->length + 1) * sizeof(EmojicodeChar)));
+    EmojicodeChar symbol = thread->variable(0).character;
+    bool compact = string->compact && symbol <= compactCharacterMax;
 
-    Object *ostro = newObject(CL_STRING);
+    Object *ostro = newString(string->length + 1, compact, thread);
     auto *ostr = ostro->val<String>();
     string = thread->thisObject()->val<String>();
 
-    ostr->length = string->length + 1;
-    ostr->charactersObject = co.unretainedPointer();
-
-    std::memcpy(ostr->characters(), string->characters(), string->length * sizeof(EmojicodeChar));
-
-    ostr->characters()[string->length] = thread->variable(0).character;
+    copyCharacters(ostr, 0, string, 0, string->length);
+    if (compact) {
+        ostr->compactCharacters()[string->length] = symbol;
+    }
+    else {
+        ostr->characters()[string->length] = symbol;
+    }
 
-    thread->release(1);
     thread->returnFromFunction(ostro);
 }
 
@@ -271,7 +533,7 @@ void stringSymbolAtBridge(Thread *thread) {
         return;
     }
 
-    thread->returnOEValueFromFunction(str->characters()[index]);
+    thread->returnOEValueFromFunction(str->characterAt(index));
 }
 
 void stringBeginsWithBridge(Thread *thread) {
@@ -282,8 +544,9 @@ void stringBeginsWithBridge(Thread *thread) {
         return;
     }
 
-    thread->returnFromFunction(std::memcmp(a->characters(), with->characters(),
-                                           with->length * sizeof(EmojicodeChar)) == 0);
+    thread->returnFromFunction(withCharacters(a, with, [with](auto characters, auto withCharacters) {
+        return std::equal(withCharacters, withCharacters + with->length, characters);
+    }));
 }
 
 void stringEndsWithBridge(Thread *thread) {
@@ -294,8 +557,9 @@ void stringEndsWithBridge(Thread *thread) {
         return;
     }
 
-    thread->returnFromFunction(std::memcmp(a->characters() + (a->length - end->length),
-                                           end->characters(), end->length * sizeof(EmojicodeChar)) == 0);
+    thread->returnFromFunction(withCharacters(a, end, [a, end](auto characters, auto endCharacters) {
+        return std::equal(endCharacters, endCharacters + end->length, characters + (a->length - end->length));
+    }));
 }
 
 void stringSplitBySymbolBridge(Thread *thread) {
@@ -303,17 +567,19 @@ void stringSplitBySymbolBridge(Thread *thread) {
     auto list = thread->retain(newObject(CL_LIST));
 
     EmojicodeInteger from = 0;
-
-    for (EmojicodeInteger i = 0, l = thread->thisObject()->val<String>()->length; i < l; i++) {
-        if (thread->thisObject()->val<String>()->characters()[i] == separator) {
-            listAppendDestination(list, thread)->copySingleValue(T_OBJECT, stringSubstring(from, i - from, thread));
-            from = i + 1;
+    while (true) {
+        auto *string = thread->thisObject()->val<String>();
+        EmojicodeInteger index = from + withCharacters(string, [string, from, separator](auto characters) {
+            return static_cast<EmojicodeInteger>(StringKernels::find(characters + from, string->length - from,
+                                                                     separator));
+        });
+        if (index == string->length) {
+            break;
         }
+        listAppendSubstring(list, from, index, thread);
+        from = index + 1;
     }
-
-    Object *stringObject = thread->thisObject();
-    listAppendDestination(list, thread)->copySingleValue(T_OBJECT,
-                                    stringSubstring(from, stringObject->val<String>()->length - from, thread));
+    listAppendSubstring(list, from, thread->thisObject()->val<String>()->length, thread);
 
     thread->release(1);
     thread->returnFromFunction(list.unretainedPointer());
@@ -322,12 +588,12 @@ void stringSplitBySymbolBridge(Thread *thread) {
 void stringToData(Thread *thread) {
     auto *str = thread->thisObject()->val<String>();
 
-    size_t ds = u8_codingsize(str->characters(), str->length);
+    size_t ds = utf8Size(str);
 
     auto bytesObject = thread->retain(newArray(ds));
 
     str = thread->thisObject()->val<String>();
-    u8_toutf8(bytesObject->val<char>(), ds, str->characters(), str->length);
+    encodeUTF8(str, bytesObject->val<char>(), ds);
 
     Object *o = newObject(CL_DATA);
     auto *d = o->val<Data>();
@@ -340,11 +606,11 @@ void stringToData(Thread *thread) {
 }
 
 void stringToCharacterList(Thread *thread) {
-    auto *str = thread->thisObject()->val<String>();
     auto list = thread->retain(newObject(CL_LIST));
 
-    for (size_t i = 0; i < str->length; i++) {
-        listAppendDestination(list, thread)->copySingleValue(T_SYMBOL, str->characters()[i]);
+    for (EmojicodeInteger i = 0; i < thread->thisObject()->val<String>()->length; i++) {
+        Box *destination = listAppendDestination(list, thread);
+        destination->copySingleValue(T_SYMBOL, thread->thisObject()->val<String>()->characterAt(i));
     }
 
     thread->returnFromFunction(list.unretainedPointer());
@@ -357,15 +623,24 @@ void stringJSON(Thread *thread) {
 
 void initStringFromSymbolList(String *str, List *list) {
     size_t count = list->count;
+    bool compact = std::all_of(list->elements(), list->elements() + count, [](const Box &b) {
+        return b.isNothingness() || b.value1.character <= compactCharacterMax;
+    });
     str->length = count;
-    str->charactersObject = newArray(count * sizeof(EmojicodeChar));
+    str->compact = compact;
+    str->charactersObject = newArray(count * (compact ? sizeof(uint8_t) : sizeof(EmojicodeChar)));
 
     for (size_t i = 0; i < count; i++) {
         Box b = list->elements()[i];
         if (b.isNothingness()) {
             break;
         }
-        str->characters()[i] = b.value1.character;
+        if (compact) {
+            str->compactCharacters()[i] = b.value1.character;
+        }
+        else {
+            str->characters()[i] = b.value1.character;
+        }
     }
 }
 
@@ -378,13 +653,17 @@ void stringFromSymbolListBridge(Thread *thread) {
 void stringFromStringList(Thread *thread) {
     size_t stringSize = 0;
     size_t appendLocation = 0;
+    bool compact;
 
     {
         auto *list = thread->variable(0).object->val<List>();
         auto *glue = thread->variable(1).object->val<String>();
 
+        compact = list->count < 2 || glue->compact;
         for (size_t i = 0; i < list->count; i++) {
-            stringSize += list->elements()[i].value1.object->val<String>()->length;
+            auto *aString = list->elements()[i].value1.object->val<String>();
+            stringSize += aString->length;
+            compact = compact && aString->compact;
         }
 
         if (list->count > 0) {
@@ -392,7 +671,7 @@ void stringFromStringList(Thread *thread) {
         }
     }
 
-    Object *co = newArray(stringSize * sizeof(EmojicodeChar));
+    Object *co = newArray(stringSize * (compact ? sizeof(uint8_t) : sizeof(EmojicodeChar)));
 
     {
         auto *list = thread->variable(0).object->val<List>();
@@ -401,15 +680,14 @@ void stringFromStringList(Thread *thread) {
         auto *string = thread->thisObject()->val<String>();
         string->length = stringSize;
         string->charactersObject = co;
+        string->compact = compact;
 
         for (size_t i = 0; i < list->count; i++) {
             auto *aString = list->elements()[i].value1.object->val<String>();
-            std::memcpy(string->characters() + appendLocation, aString->characters(),
-                        aString->length * sizeof(EmojicodeChar));
+            copyCharacters(string, appendLocation, aString, 0, aString->length);
             appendLocation += aString->length;
             if (i + 1 < list->count) {
-                std::memcpy(string->characters() + appendLocation, glue->characters(),
-                            glue->length * sizeof(EmojicodeChar));
+                copyCharacters(string, appendLocation, glue, 0, glue->length);
                 appendLocation += glue->length;
             }
         }
@@ -417,7 +695,8 @@ void stringFromStringList(Thread *thread) {
     thread->returnFromFunction(thread->thisContext());
 }
 
-std::pair<EmojicodeInteger, bool> charactersToInteger(const EmojicodeChar *characters, EmojicodeInteger base,
+template <typename Character>
+std::pair<EmojicodeInteger, bool> charactersToInteger(const Character *characters, EmojicodeInteger base,
                                                       EmojicodeInteger length) {
     if (length == 0) {
         return std::make_pair(0, false);
@@ -460,7 +739,9 @@ void stringToInteger(Thread *thread) {
     EmojicodeInteger base = thread->variable(0).raw;
     auto *string = thread->thisObject()->val<String>();
 
-    auto pair = charactersToInteger(string->characters(), base, string->length);
+    auto pair = withCharacters(string, [string, base](auto characters) {
+        return charactersToInteger(characters, base, string->length);
+    });
     if (pair.second) {
         thread->returnOEValueFromFunction(pair.first);
     }
@@ -469,16 +750,8 @@ void stringToInteger(Thread *thread) {
     }
 }
 
-void stringToDouble(Thread *thread) {
-    auto *string = thread->thisObject()->val<String>();
-
-    if (string->length == 0) {
-        thread->returnNothingnessFromFunction();
-        return;
-    }
-
-    EmojicodeChar *characters = string->characters();
-
+template <typename Character>
+std::pair<double, bool> charactersToDouble(const Character *characters, EmojicodeInteger length) {
     double d = 0.0;
     bool sign = true;
     bool foundSeparator = false;
@@ -493,20 +766,18 @@ void stringToDouble(Thread *thread) {
         i++;
     }
 
-    for (; i < string->length; i++) {
+    for (; i < length; i++) {
         if (characters[i] == '.') {
             if (foundSeparator) {
-                thread->returnNothingnessFromFunction();
-                return;
+                return std::make_pair(0.0, false);
             }
             foundSeparator = true;
             continue;
         }
         if (characters[i] == 'e' || characters[i] == 'E') {
-            auto exponent = charactersToInteger(characters + i + 1, 10, string->length - i - 1);
+            auto exponent = charactersToInteger(characters + i + 1, 10, length - i - 1);
             if (!exponent.second) {
-                thread->returnNothingnessFromFunction();
-                return;
+                return std::make_pair(0.0, false);
             }
             d *= pow(10, exponent.first);
             break;
@@ -519,14 +790,12 @@ void stringToDouble(Thread *thread) {
             }
             foundDigit = true;
         } else {
-            thread->returnNothingnessFromFunction();
-            return;
+            return std::make_pair(0.0, false);
         }
     }
 
     if (!foundDigit) {
-        thread->returnNothingnessFromFunction();
-        return;
+        return std::make_pair(0.0, false);
     }
 
     d /= pow(10, decimalPlace);
@@ -534,57 +803,208 @@ void stringToDouble(Thread *thread) {
     if (!sign) {
         d *= -1;
     }
-    thread->returnOEValueFromFunction(d);
+    return std::make_pair(d, true);
 }
 
-void stringToUppercase(Thread *thread) {
-    auto o = thread->retain(newObject(CL_STRING));
-    size_t length = thread->thisObject()->val<String>()->length;
+void stringToDouble(Thread *thread) {
+    auto *string = thread->thisObject()->val<String>();
 
-    Object *characters = newArray(length * sizeof(EmojicodeChar));
-    auto *news = o->val<String>();
-    news->charactersObject = characters;
-    news->length = length;
+    if (string->length == 0) {
+        thread->returnNothingnessFromFunction();
+        return;
+    }
+
+    auto pair = withCharacters(string, [string](auto characters) {
+        return charactersToDouble(characters, string->length);
+    });
+    if (pair.second) {
+        thread->returnOEValueFromFunction(pair.first);
+    }
+    else {
+        thread->returnNothingnessFromFunction();
+    }
+}
+
+/// Returns a copy of the string in the this-slot whose ASCII letters were converted to uppercase if @c uppercase is
+/// true or to lowercase otherwise.
+/// @warning GC-invoking
+Object* stringChangeCase(Thread *thread, bool uppercase) {
     auto *os = thread->thisObject()->val<String>();
-    for (size_t i = 0; i < length; i++) {
-        EmojicodeChar c = os->characters()[i];
-        if (c <= 'z') {
-            news->characters()[i] = toupper(c);
+    Object *o = newString(os->length, os->compact, thread);
+    auto *news = o->val<String>();
+    os = thread->thisObject()->val<String>();
+    if (os->compact && uppercase) {
+        StringKernels::toUppercase(os->compactCharacters(), os->length, news->compactCharacters());
+    }
+    else if (os->compact) {
+        StringKernels::toLowercase(os->compactCharacters(), os->length, news->compactCharacters());
+    }
+    else if (uppercase) {
+        StringKernels::toUppercase(os->characters(), os->length, news->characters());
+    }
+    else {
+        StringKernels::toLowercase(os->characters(), os->length, news->characters());
+    }
+    return o;
+}
+
+void stringToUppercase(Thread *thread) {
+    thread->returnFromFunction(stringChangeCase(thread, true));
+}
+
+void stringToLowercase(Thread *thread) {
+    thread->returnFromFunction(stringChangeCase(thread, false));
+}
+
+void stringCompareBridge(Thread *thread) {
+    auto *a = thread->thisObject()->val<String>();
+    auto *b = thread->variable(0).object->val<String>();
+    thread->returnFromFunction(stringCompare(a, b));
+}
+
+void stringBuilderInit(Thread *thread) {
+    thread->thisObject()->val<StringBuilder>()->compact = true;
+    thread->returnFromFunction(thread->thisContext());
+}
+
+void stringBuilderInitWithCapacity(Thread *thread) {
+    EmojicodeInteger capacity = std::max(thread->variable(0).raw, EmojicodeInteger(0));
+    Object *characters = newArray(capacity * sizeof(uint8_t));
+    auto *builder = thread->thisObject()->val<StringBuilder>();
+    builder->charactersObject = characters;
+    builder->capacity = capacity;
+    builder->compact = true;
+    thread->returnFromFunction(thread->thisContext());
+}
+
+/// Makes room for @c count more characters in the builder in the this-slot and returns the builder. Unless @c compact
+/// is true, the characters of the builder are widened to UTF-32. The capacity is at least doubled when it is
+/// exceeded, so that appending is amortized constant.
+/// @warning GC-invoking
+StringBuilder* stringBuilderReserve(Thread *thread, EmojicodeInteger count, bool compact) {
+    auto *builder = thread->thisObject()->val<StringBuilder>();
+    bool widen = builder->compact && !compact;
+    if (!widen && builder->length + count <= builder->capacity) {
+        return builder;
+    }
+
+    EmojicodeInteger capacity = builder->capacity;
+    if (builder->length + count > capacity) {
+        capacity = std::max(std::max(capacity * 2, builder->length + count), EmojicodeInteger(16));
+    }
+
+    if (widen) {
+        Object *characters = newArray(capacity * sizeof(EmojicodeChar));
+        builder = thread->thisObject()->val<StringBuilder>();
+        if (builder->length > 0) {
+            std::copy(builder->compactCharacters(), builder->compactCharacters() + builder->length,
+                      characters->val<EmojicodeChar>());
+        }
+        builder->charactersObject = characters;
+        builder->compact = false;
+    }
+    else {
+        size_t size = capacity * (builder->compact ? sizeof(uint8_t) : sizeof(EmojicodeChar));
+        Object *characters;
+        if (builder->charactersObject == nullptr) {
+            characters = newArray(size);
         }
         else {
-            news->characters()[i] = c;
+            characters = resizeArray(builder->charactersObject, size, thread);
         }
+        builder = thread->thisObject()->val<StringBuilder>();
+        builder->charactersObject = characters;
     }
-    thread->release(1);
-    thread->returnFromFunction(o.unretainedPointer());
+    builder->capacity = capacity;
+    return builder;
 }
 
-void stringToLowercase(Thread *thread) {
-    auto o = thread->retain(newObject(CL_STRING));
-    size_t length = thread->thisObject()->val<String>()->length;
-
-    Object *characters = newArray(length * sizeof(EmojicodeChar));
-    auto *news = o->val<String>();
-    news->charactersObject = characters;
-    news->length = length;
-    auto *os = thread->thisObject()->val<String>();
-    for (size_t i = 0; i < length; i++) {
-        EmojicodeChar c = os->characters()[i];
-        if (c <= 'z') {
-            news->characters()[i] = tolower(c);
+void stringBuilderAppendString(Thread *thread) {
+    auto *string = thread->variable(0).object->val<String>();
+    auto *builder = stringBuilderReserve(thread, string->length, string->compact);
+    string = thread->variable(0).object->val<String>();
+    withCharacters(string, [builder, string](auto characters) {
+        if (builder->compact) {
+            std::copy(characters, characters + string->length, builder->compactCharacters() + builder->length);
         }
         else {
-            news->characters()[i] = c;
+            std::copy(characters, characters + string->length, builder->characters() + builder->length);
         }
+    });
+    builder->length += string->length;
+    thread->returnFromFunction();
+}
+
+void stringBuilderAppendSymbol(Thread *thread) {
+    EmojicodeChar symbol = thread->variable(0).character;
+    auto *builder = stringBuilderReserve(thread, 1, symbol <= compactCharacterMax);
+    if (builder->compact) {
+        builder->compactCharacters()[builder->length] = symbol;
     }
-    thread->release(1);
-    thread->returnFromFunction(o.unretainedPointer());
+    else {
+        builder->characters()[builder->length] = symbol;
+    }
+    builder->length++;
+    thread->returnFromFunction();
 }
 
-void stringCompareBridge(Thread *thread) {
-    auto *a = thread->thisObject()->val<String>();
-    auto *b = thread->variable(0).object->val<String>();
-    thread->returnFromFunction(stringCompare(a, b));
+/// Appends @c count characters written by @c write, which is called with a pointer to the end of the characters, to
+/// the builder in the this-slot.
+/// @warning GC-invoking
+template <typename Write>
+void stringBuilderAppendASCII(Thread *thread, EmojicodeInteger count, Write write) {
+    auto *builder = stringBuilderReserve(thread, count, true);
+    if (builder->compact) {
+        write(builder->compactCharacters() + builder->length + count);
+    }
+    else {
+        std::vector<uint8_t> characters(count);
+        write(characters.data() + count);
+        std::copy(characters.begin(), characters.end(), builder->characters() + builder->length);
+    }
+    builder->length += count;
+}
+
+void stringBuilderAppendInteger(Thread *thread) {
+    EmojicodeInteger n = thread->variable(0).raw;
+    EmojicodeInteger base = thread->variable(1).raw;
+    stringBuilderAppendASCII(thread, integerCharacterCount(n, base), [n, base](uint8_t *end) {
+        writeInteger(n, base, end);
+    });
+    thread->returnFromFunction();
+}
+
+void stringBuilderAppendDouble(Thread *thread) {
+    double d = thread->variable(0).doubl;
+    EmojicodeInteger precision = thread->variable(1).raw;
+    stringBuilderAppendASCII(thread, doubleCharacterCount(d, precision), [d, precision](uint8_t *end) {
+        writeDouble(d, precision, end);
+    });
+    thread->returnFromFunction();
+}
+
+void stringBuilderLength(Thread *thread) {
+    thread->returnFromFunction(thread->thisObject()->val<StringBuilder>()->length);
+}
+
+void stringBuilderToString(Thread *thread) {
+    if (thread->thisObject()->val<StringBuilder>()->length == 0) {
+        thread->returnFromFunction(emptyString);
+        return;
+    }
+
+    Object *stringObject = newObject(CL_STRING);
+    auto *builder = thread->thisObject()->val<StringBuilder>();
+    auto *string = stringObject->val<String>();
+    string->length = builder->length;
+    string->charactersObject = builder->charactersObject;
+    string->compact = builder->compact;
+
+    builder->length = 0;
+    builder->capacity = 0;
+    builder->charactersObject = nullptr;
+    builder->compact = true;
+    thread->returnFromFunction(stringObject);
 }
 
 void stringMark(Object *self) {
@@ -594,4 +1014,11 @@ void stringMark(Object *self) {
     }
 }
 
+void stringBuilderMark(Object *self) {
+    auto builder = self->val<StringBuilder>();
+    if (builder->charactersObject) {
+        mark(&builder->charactersObject);
+    }
+}
+
 }  // namespace Emojicode
@@ -17,32 +17,114 @@ namespace Emojicode {
 struct String {
     /// The number of characters. Strings are not null terminated.
     EmojicodeInteger length;
-    /// The characters (Unicode Codepoints, @c EmojicodeChar) of this string.
+    /// The object containing the characters of this string. If @c compact is true, every character is stored as a
+    /// single byte (Latin-1), otherwise as @c EmojicodeChar (Unicode Codepoints).
     Object *charactersObject;
+    /// The index of the first character of this string in @c charactersObject. Substrings share the characters object
+    /// of the string they were taken from, which must therefore never be modified once a string was created.
+    EmojicodeInteger offset;
+    /// The hash of the characters as returned by @c stringHash(), or 0 if it was not yet computed. Code that changes
+    /// the characters of a string after it was initialized must reset it to 0.
+    uint64_t hash;
+    /// Whether the characters are stored as Latin-1. Strings are created compact whenever all their characters are
+    /// below 256, but code must not rely on it: a string that is not compact may still only contain such characters.
+    bool compact;
+
+    /// Returns the characters of a string that is not compact.
+    EmojicodeChar* characters() { return charactersObject->val<EmojicodeChar>() + offset; }
+    /// Returns the characters of a compact string.
+    uint8_t* compactCharacters() { return charactersObject->val<uint8_t>() + offset; }
+    /// Returns the character at @c index regardless of how the characters are stored.
+    EmojicodeChar characterAt(EmojicodeInteger index) {
+        return compact ? compactCharacters()[index] : characters()[index];
+    }
+};
+
+/// The largest character that can be stored in a compact string.
+const EmojicodeChar compactCharacterMax = 0xFF;
+
+/// Calls @c function with a pointer to the characters of @c string, which is a @c const uint8_t* if the string is
+/// compact and a @c const EmojicodeChar* otherwise, and returns its result.
+template <typename Function>
+inline auto withCharacters(String *string, Function function) {
+    if (string->compact) {
+        return function(static_cast<const uint8_t *>(string->compactCharacters()));
+    }
+    return function(static_cast<const EmojicodeChar *>(string->characters()));
+}
+
+/// The value area of 🏗. Its characters are stored like those of a string in @c charactersObject, which has room for
+/// @c capacity characters and is handed over to the string that 🔡 creates.
+struct StringBuilder {
+    EmojicodeInteger length;
+    EmojicodeInteger capacity;
+    Object *charactersObject;
+    bool compact;
 
     EmojicodeChar* characters() { return charactersObject->val<EmojicodeChar>(); }
+    uint8_t* compactCharacters() { return charactersObject->val<uint8_t>(); }
 };
 
+/// Returns true if all @c count characters are below 256 and can therefore be stored in a compact string.
+bool charactersFitCompact(const EmojicodeChar *characters, size_t count);
+
+/// Creates a string of @c length characters, which are stored compactly if @c compact is true. The characters are
+/// zero and must be set by the caller. Returns the empty string if @c length is 0.
+/// @warning GC-invoking
+Object* newString(EmojicodeInteger length, bool compact, Thread *thread);
+
+/// Copies @c count characters of @c source starting at @c from into the characters of @c destination starting at
+/// @c offset. The characters must fit @c destination if it is compact.
+void copyCharacters(String *destination, EmojicodeInteger offset, String *source, EmojicodeInteger from,
+                    EmojicodeInteger count);
+
 extern Object **stringPool;
 #define emptyString (stringPool[0])
 
 /** Compares if the value of @c a is equal to @c b. */
 bool stringEqual(String *a, String *b);
 
+/// Returns a negative integer, zero or a positive integer if @c a comes before, is equal to or comes after @c b. Shorter
+/// strings come first and strings of equal length are ordered by their characters, as by ↔️.
+EmojicodeInteger stringCompare(String *a, String *b);
+
+/// Returns the hash of the characters of @c string, which is computed on first use and then cached in the string.
+/// The returned hash is never 0.
+uint64_t stringHash(String *string);
+
 /// Converts the string to a UTF8 char array and returns it.
 /// @warning The returned pointer points into an object allocated by the Emojicode memory manager. It must not be free’d
 /// and will not survive the imminent garbage collector cycle.
 const char* stringToCString(Object *str);
 
+/// Returns the number of characters needed to represent @c n in @c base.
+EmojicodeInteger integerCharacterCount(EmojicodeInteger n, EmojicodeInteger base);
+/// Writes the characters that represent @c n in @c base so that they end right before @c end.
+void writeInteger(EmojicodeInteger n, EmojicodeInteger base, uint8_t *end);
+/// Returns the number of characters needed to represent @c d with @c precision fractional digits.
+EmojicodeInteger doubleCharacterCount(double d, EmojicodeInteger precision);
+/// Writes the characters that represent @c d with @c precision fractional digits so that they end right before @c end.
+void writeDouble(double d, EmojicodeInteger precision, uint8_t *end);
+
 /** Creates a string from a UTF8 C string. The string must be null terminated! */
 Object* stringFromChar(const char *cstring);
 
+/// Determines the number of characters encoded by @c size bytes of UTF8 and whether they fit into a compact string.
+void measureUTF8(const char *utf8, size_t size, EmojicodeInteger *length, bool *compact);
+/// Decodes @c size bytes of UTF8 into the characters of @c string, which must have been created with the length and
+/// representation returned by @c measureUTF8().
+void decodeUTF8(String *string, const char *utf8, size_t size);
+/// Creates a string from @c size bytes of UTF8. @c utf8 must not point into an object of the Emojicode memory manager.
+/// @warning GC-invoking
+Object* stringFromUTF8(const char *utf8, size_t size, Thread *thread);
+
 /**
  * Tries to parse the string in the this-slot on the stack as JSON.
  */
 void parseJSON(Thread *thread, Box *destination);
 
 void stringMark(Object *self);
+void stringBuilderMark(Object *self);
 
 void initStringFromSymbolList(String *string, List *list);
 
@@ -70,6 +152,14 @@ void stringToDouble(Thread *thread);
 void stringToUppercase(Thread *thread);
 void stringToLowercase(Thread *thread);
 void stringCompareBridge(Thread *thread);
+void stringBuilderInit(Thread *thread);
+void stringBuilderInitWithCapacity(Thread *thread);
+void stringBuilderAppendString(Thread *thread);
+void stringBuilderAppendSymbol(Thread *thread);
+void stringBuilderAppendInteger(Thread *thread);
+void stringBuilderAppendDouble(Thread *thread);
+void stringBuilderLength(Thread *thread);
+void stringBuilderToString(Thread *thread);
 
 }
 
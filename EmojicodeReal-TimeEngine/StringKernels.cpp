@@ -0,0 +1,297 @@
+//
+//  StringKernels.cpp
+//  Emojicode
+//
+
+#include "StringKernels.hpp"
+#include "Engine.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define EMOJICODE_AVX2_KERNELS
+#endif
+
+namespace Emojicode {
+namespace StringKernels {
+
+template <typename Character>
+struct Kernels {
+    size_t (*find)(const Character *characters, size_t count, Character c);
+    size_t (*search)(const Character *characters, size_t count, const Character *needle, size_t needleCount);
+    /// Copies the characters to @c destination and flips the case bit of all characters between @c first and
+    /// @c last, inclusive.
+    void (*mapCase)(const Character *characters, size_t count, Character *destination, Character first,
+                    Character last);
+};
+
+namespace Scalar {
+
+template <typename Character>
+size_t find(const Character *characters, size_t count, Character c) {
+    return std::find(characters, characters + count, c) - characters;
+}
+
+template <typename Character>
+size_t search(const Character *characters, size_t count, const Character *needle, size_t needleCount) {
+    return std::search(characters, characters + count, needle, needle + needleCount) - characters;
+}
+
+template <typename Character>
+void mapCase(const Character *characters, size_t count, Character *destination, Character first, Character last) {
+    for (size_t i = 0; i < count; i++) {
+        Character c = characters[i];
+        destination[i] = first <= c && c <= last ? c ^ 0x20 : c;
+    }
+}
+
+}  // namespace Scalar
+
+// The vector kernels process as many characters at once as fit into a vector and leave the remainder to the scalar
+// kernels. The helpers take a character as last argument only to select the lane width.
+
+#ifdef __SSE2__
+namespace SSE2 {
+
+inline __m128i load(const void *p) { return _mm_loadu_si128(static_cast<const __m128i *>(p)); }
+inline void store(void *p, __m128i v) { _mm_storeu_si128(static_cast<__m128i *>(p), v); }
+inline __m128i splat(uint8_t c) { return _mm_set1_epi8(static_cast<char>(c)); }
+inline __m128i splat(EmojicodeChar c) { return _mm_set1_epi32(static_cast<int>(c)); }
+/// Returns a mask with one bit per lane, which is set if the lanes of @c a and @c b are equal.
+inline uint32_t equal(__m128i a, __m128i b, uint8_t) { return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)); }
+inline uint32_t equal(__m128i a, __m128i b, EmojicodeChar) {
+    return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)));
+}
+inline __m128i greater(__m128i a, __m128i b, uint8_t) { return _mm_cmpgt_epi8(a, b); }
+inline __m128i greater(__m128i a, __m128i b, EmojicodeChar) { return _mm_cmpgt_epi32(a, b); }
+
+template <typename Character>
+size_t find(const Character *characters, size_t count, Character c) {
+    constexpr size_t lanes = sizeof(__m128i) / sizeof(Character);
+    __m128i needle = splat(c);
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        uint32_t mask = equal(load(characters + i), needle, c);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + Scalar::find(characters + i, count - i, c);
+}
+
+/// Compares the first and the last character of the needle with a vector of possible starting positions at once and
+/// only compares the remaining characters at positions where both match.
+template <typename Character>
+size_t search(const Character *characters, size_t count, const Character *needle, size_t needleCount) {
+    if (needleCount == 1) {
+        return find(characters, count, needle[0]);
+    }
+    if (needleCount == 0 || needleCount > count) {
+        return Scalar::search(characters, count, needle, needleCount);
+    }
+
+    constexpr size_t lanes = sizeof(__m128i) / sizeof(Character);
+    size_t positions = count - needleCount + 1;
+    __m128i first = splat(needle[0]);
+    __m128i last = splat(needle[needleCount - 1]);
+    size_t i = 0;
+    for (; i + lanes <= positions; i += lanes) {
+        uint32_t mask = equal(load(characters + i), first, needle[0]) &
+                        equal(load(characters + i + needleCount - 1), last, needle[0]);
+        for (; mask != 0; mask &= mask - 1) {
+            size_t candidate = i + __builtin_ctz(mask);
+            if (std::memcmp(characters + candidate + 1, needle + 1, (needleCount - 2) * sizeof(Character)) == 0) {
+                return candidate;
+            }
+        }
+    }
+    return i + Scalar::search(characters + i, count - i, needle, needleCount);
+}
+
+template <typename Character>
+void mapCase(const Character *characters, size_t count, Character *destination, Character first, Character last) {
+    constexpr size_t lanes = sizeof(__m128i) / sizeof(Character);
+    __m128i below = splat(static_cast<Character>(first - 1));
+    __m128i above = splat(static_cast<Character>(last + 1));
+    __m128i caseBit = splat(static_cast<Character>(0x20));
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        __m128i v = load(characters + i);
+        __m128i inRange = _mm_and_si128(greater(v, below, first), greater(above, v, first));
+        store(destination + i, _mm_xor_si128(v, _mm_and_si128(inRange, caseBit)));
+    }
+    Scalar::mapCase(characters + i, count - i, destination + i, first, last);
+}
+
+}  // namespace SSE2
+#endif
+
+#ifdef EMOJICODE_AVX2_KERNELS
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+namespace AVX2 {
+
+AVX2_FUNCTION inline __m256i load(const void *p) { return _mm256_loadu_si256(static_cast<const __m256i *>(p)); }
+AVX2_FUNCTION inline void store(void *p, __m256i v) { _mm256_storeu_si256(static_cast<__m256i *>(p), v); }
+AVX2_FUNCTION inline __m256i splat(uint8_t c) { return _mm256_set1_epi8(static_cast<char>(c)); }
+AVX2_FUNCTION inline __m256i splat(EmojicodeChar c) { return _mm256_set1_epi32(static_cast<int>(c)); }
+AVX2_FUNCTION inline uint32_t equal(__m256i a, __m256i b, uint8_t) {
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+}
+AVX2_FUNCTION inline uint32_t equal(__m256i a, __m256i b, EmojicodeChar) {
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)));
+}
+AVX2_FUNCTION inline __m256i greater(__m256i a, __m256i b, uint8_t) { return _mm256_cmpgt_epi8(a, b); }
+AVX2_FUNCTION inline __m256i greater(__m256i a, __m256i b, EmojicodeChar) { return _mm256_cmpgt_epi32(a, b); }
+
+template <typename Character>
+AVX2_FUNCTION size_t find(const Character *characters, size_t count, Character c) {
+    constexpr size_t lanes = sizeof(__m256i) / sizeof(Character);
+    __m256i needle = splat(c);
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        uint32_t mask = equal(load(characters + i), needle, c);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + Scalar::find(characters + i, count - i, c);
+}
+
+template <typename Character>
+AVX2_FUNCTION size_t search(const Character *characters, size_t count, const Character *needle,
+                            size_t needleCount) {
+    if (needleCount == 1) {
+        return find(characters, count, needle[0]);
+    }
+    if (needleCount == 0 || needleCount > count) {
+        return Scalar::search(characters, count, needle, needleCount);
+    }
+
+    constexpr size_t lanes = sizeof(__m256i) / sizeof(Character);
+    size_t positions = count - needleCount + 1;
+    __m256i first = splat(needle[0]);
+    __m256i last = splat(needle[needleCount - 1]);
+    size_t i = 0;
+    for (; i + lanes <= positions; i += lanes) {
+        uint32_t mask = equal(load(characters + i), first, needle[0]) &
+                        equal(load(characters + i + needleCount - 1), last, needle[0]);
+        for (; mask != 0; mask &= mask - 1) {
+            size_t candidate = i + __builtin_ctz(mask);
+            if (std::memcmp(characters + candidate + 1, needle + 1, (needleCount - 2) * sizeof(Character)) == 0) {
+                return candidate;
+            }
+        }
+    }
+    return i + Scalar::search(characters + i, count - i, needle, needleCount);
+}
+
+template <typename Character>
+AVX2_FUNCTION void mapCase(const Character *characters, size_t count, Character *destination, Character first,
+                           Character last) {
+    constexpr size_t lanes = sizeof(__m256i) / sizeof(Character);
+    __m256i below = splat(static_cast<Character>(first - 1));
+    __m256i above = splat(static_cast<Character>(last + 1));
+    __m256i caseBit = splat(static_cast<Character>(0x20));
+    size_t i = 0;
+    for (; i + lanes <= count; i += lanes) {
+        __m256i v = load(characters + i);
+        __m256i inRange = _mm256_and_si256(greater(v, below, first), greater(above, v, first));
+        store(destination + i, _mm256_xor_si256(v, _mm256_and_si256(inRange, caseBit)));
+    }
+    Scalar::mapCase(characters + i, count - i, destination + i, first, last);
+}
+
+}  // namespace AVX2
+#endif
+
+Kernels<uint8_t> compactKernels = {Scalar::find<uint8_t>, Scalar::search<uint8_t>, Scalar::mapCase<uint8_t>};
+Kernels<EmojicodeChar> wideKernels = {
+    Scalar::find<EmojicodeChar>, Scalar::search<EmojicodeChar>, Scalar::mapCase<EmojicodeChar>
+};
+
+void select() {
+    enum class Implementation { Scalar, SSE2, AVX2 };
+
+    bool sse2 = false, avx2 = false;
+#ifdef __SSE2__
+    sse2 = true;
+#endif
+#ifdef EMOJICODE_AVX2_KERNELS
+    __builtin_cpu_init();
+    avx2 = __builtin_cpu_supports("avx2");
+#endif
+    Implementation implementation = avx2 ? Implementation::AVX2 :
+                                    (sse2 ? Implementation::SSE2 : Implementation::Scalar);
+
+    if (const char *name = getenv("EMOJICODE_STRING_KERNELS")) {
+        if (std::strcmp(name, "scalar") == 0) {
+            implementation = Implementation::Scalar;
+        }
+        else if (std::strcmp(name, "sse2") == 0 && sse2) {
+            implementation = Implementation::SSE2;
+        }
+        else if (std::strcmp(name, "avx2") == 0 && avx2) {
+            implementation = Implementation::AVX2;
+        }
+        else {
+            error("String kernels %s are unknown or not supported by this CPU. Use scalar, sse2 or avx2.", name);
+        }
+    }
+
+    switch (implementation) {
+        case Implementation::Scalar:
+            break;
+        case Implementation::SSE2:
+#ifdef __SSE2__
+            compactKernels = {SSE2::find<uint8_t>, SSE2::search<uint8_t>, SSE2::mapCase<uint8_t>};
+            wideKernels = {SSE2::find<EmojicodeChar>, SSE2::search<EmojicodeChar>, SSE2::mapCase<EmojicodeChar>};
+#endif
+            break;
+        case Implementation::AVX2:
+#ifdef EMOJICODE_AVX2_KERNELS
+            compactKernels = {AVX2::find<uint8_t>, AVX2::search<uint8_t>, AVX2::mapCase<uint8_t>};
+            wideKernels = {AVX2::find<EmojicodeChar>, AVX2::search<EmojicodeChar>, AVX2::mapCase<EmojicodeChar>};
+#endif
+            break;
+    }
+}
+
+size_t find(const uint8_t *characters, size_t count, EmojicodeChar c) {
+    if (c > 0xFF) {
+        return count;
+    }
+    return compactKernels.find(characters, count, static_cast<uint8_t>(c));
+}
+
+size_t find(const EmojicodeChar *characters, size_t count, EmojicodeChar c) {
+    return wideKernels.find(characters, count, c);
+}
+
+size_t search(const uint8_t *characters, size_t count, const uint8_t *needle, size_t needleCount) {
+    return compactKernels.search(characters, count, needle, needleCount);
+}
+
+size_t search(const EmojicodeChar *characters, size_t count, const EmojicodeChar *needle, size_t needleCount) {
+    return wideKernels.search(characters, count, needle, needleCount);
+}
+
+void toUppercase(const uint8_t *characters, size_t count, uint8_t *destination) {
+    compactKernels.mapCase(characters, count, destination, 'a', 'z');
+}
+
+void toUppercase(const EmojicodeChar *characters, size_t count, EmojicodeChar *destination) {
+    wideKernels.mapCase(characters, count, destination, 'a', 'z');
+}
+
+void toLowercase(const uint8_t *characters, size_t count, uint8_t *destination) {
+    compactKernels.mapCase(characters, count, destination, 'A', 'Z');
+}
+
+void toLowercase(const EmojicodeChar *characters, size_t count, EmojicodeChar *destination) {
+    wideKernels.mapCase(characters, count, destination, 'A', 'Z');
+}
+
+}  // namespace StringKernels
+}  // namespace Emojicode
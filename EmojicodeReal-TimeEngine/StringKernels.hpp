@@ -0,0 +1,44 @@
+//
+//  StringKernels.hpp
+//  Emojicode
+//
+
+#ifndef StringKernels_hpp
+#define StringKernels_hpp
+
+#include "EmojicodeAPI.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace Emojicode {
+
+/// Loops over the characters of strings, which are implemented with SSE2 and AVX2 on x86-64 and with scalar code
+/// everywhere else. Every kernel is provided for compact (@c uint8_t) and for UTF-32 (@c EmojicodeChar) characters.
+///
+/// The implementation is chosen by @c select() based on the CPU. It can be overridden by setting the environment
+/// variable EMOJICODE_STRING_KERNELS to scalar, sse2 or avx2.
+namespace StringKernels {
+    /// Selects the implementation of the kernels. Must be called before any kernel is used.
+    void select();
+
+    /// Returns the index of the first occurrence of @c c in the @c count characters or @c count if there is none.
+    size_t find(const uint8_t *characters, size_t count, EmojicodeChar c);
+    size_t find(const EmojicodeChar *characters, size_t count, EmojicodeChar c);
+
+    /// Returns the index of the first occurrence of the @c needleCount characters of @c needle in the @c count
+    /// characters or @c count if there is none. An empty needle is found at index 0.
+    size_t search(const uint8_t *characters, size_t count, const uint8_t *needle, size_t needleCount);
+    size_t search(const EmojicodeChar *characters, size_t count, const EmojicodeChar *needle, size_t needleCount);
+
+    /// Copies the @c count characters to @c destination and converts the ASCII letters to uppercase.
+    void toUppercase(const uint8_t *characters, size_t count, uint8_t *destination);
+    void toUppercase(const EmojicodeChar *characters, size_t count, EmojicodeChar *destination);
+
+    /// Copies the @c count characters to @c destination and converts the ASCII letters to lowercase.
+    void toLowercase(const uint8_t *characters, size_t count, uint8_t *destination);
+    void toLowercase(const EmojicodeChar *characters, size_t count, EmojicodeChar *destination);
+}  // namespace StringKernels
+
+}  // namespace Emojicode
+
+#endif /* StringKernels_hpp */
@@ -0,0 +1,176 @@
+//
+//  TaskPool.cpp
+//  Emojicode
+//
+
+#include "TaskPool.hpp"
+#include "Fiber.hpp"
+#include "Memory.hpp"
+#include "Thread.hpp"
+#include "ThreadsManager.hpp"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <vector>
+
+namespace Emojicode {
+namespace TaskPool {
+
+struct Task {
+    Object *callable;
+    Object *future;
+};
+
+struct Worker {
+    size_t index;
+    std::mutex mutex;
+    std::deque<Task> tasks;
+};
+
+/// The workers run until the program exits. The pool is therefore never deallocated, which also ensures that no
+/// destructor of a static object waits for a worker that is blocked on it.
+struct Pool {
+    std::vector<Worker *> workers;
+    std::atomic_size_t nextWorker{0};
+    /// The number of tasks in all queues. Idle workers wait on idleCondition until it becomes positive.
+    std::atomic_size_t queuedTasks{0};
+    /// The number of workers waiting on idleCondition for a future, which must also be woken when a task is done.
+    std::atomic_size_t futureWaiters{0};
+    std::mutex idleMutex;
+    std::condition_variable idleCondition;
+};
+
+Pool *pool = nullptr;
+std::once_flag poolStarted;
+thread_local Worker *currentWorker = nullptr;
+
+bool take(Worker *worker, Task &task) {
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        if (!worker->tasks.empty()) {
+            task = worker->tasks.back();
+            worker->tasks.pop_back();
+            pool->queuedTasks--;
+            return true;
+        }
+    }
+    for (size_t i = 1; i < pool->workers.size(); i++) {
+        Worker *victim = pool->workers[(worker->index + i) % pool->workers.size()];
+        std::lock_guard<std::mutex> lock(victim->mutex);
+        if (!victim->tasks.empty()) {
+            task = victim->tasks.front();
+            victim->tasks.pop_front();
+            pool->queuedTasks--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void run(Thread *thread, Task task) {
+    auto future = thread->retain(task.future);
+    Box value;
+    executeCallableExtern(task.callable, nullptr, 0, thread, reinterpret_cast<Value *>(&value));
+    future->val<Future>()->value = value;
+    FutureState *state = future->val<Future>()->futureState();
+    thread->release(1);
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->done = true;
+        for (auto fiber : state->waiters) {
+            Fibers::unpark(fiber);
+        }
+    }
+    state->condition.notify_all();
+    if (pool->futureWaiters > 0) {
+        {
+            std::lock_guard<std::mutex> lock(pool->idleMutex);
+        }
+        pool->idleCondition.notify_all();
+    }
+}
+
+void work(Thread *thread, Worker *worker) {
+    Thread::setCurrent(thread);
+    currentWorker = worker;
+    while (true) {
+        pauseForGC();
+        Task task;
+        if (take(worker, task)) {
+            run(thread, task);
+            continue;
+        }
+        BlockingRegion region;
+        std::unique_lock<std::mutex> lock(pool->idleMutex);
+        pool->idleCondition.wait(lock, [] { return pool->queuedTasks > 0; });
+    }
+}
+
+void startPool() {
+    pool = new Pool;
+    size_t count = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < count; i++) {
+        auto worker = new Worker;
+        worker->index = i;
+        pool->workers.push_back(worker);
+    }
+    for (auto worker : pool->workers) {
+        std::thread(work, ThreadsManager::allocateThread(), worker).detach();
+    }
+}
+
+void submit(Object *callable, Object *future) {
+    std::call_once(poolStarted, startPool);
+    Worker *worker = currentWorker != nullptr ? currentWorker : pool->workers[pool->nextWorker++ % pool->workers.size()];
+    {
+        // The count must include the task before a thief can take it and decrement the count.
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->tasks.push_back(Task{callable, future});
+        pool->queuedTasks++;
+    }
+    {
+        // An idle worker that did not see the task yet is either before its check or already waiting.
+        std::lock_guard<std::mutex> lock(pool->idleMutex);
+    }
+    pool->idleCondition.notify_one();
+}
+
+bool runQueuedTask(Thread *thread) {
+    Task task;
+    if (currentWorker == nullptr || !take(currentWorker, task)) {
+        return false;
+    }
+    run(thread, task);
+    return true;
+}
+
+void waitForTaskOrFuture(FutureState *state) {
+    // Either this worker sees that the task is done, or the worker that completed it sees the waiter and notifies.
+    pool->futureWaiters++;
+    {
+        BlockingRegion region;
+        std::unique_lock<std::mutex> lock(pool->idleMutex);
+        pool->idleCondition.wait(lock, [state] { return pool->queuedTasks > 0 || state->done; });
+    }
+    pool->futureWaiters--;
+}
+
+bool isWorker() {
+    return currentWorker != nullptr;
+}
+
+void markTasks() {
+    if (pool == nullptr) {
+        return;
+    }
+    for (auto worker : pool->workers) {
+        for (auto &task : worker->tasks) {
+            mark(&task.callable);
+            mark(&task.future);
+        }
+    }
+}
+
+}  // namespace TaskPool
+}  // namespace Emojicode
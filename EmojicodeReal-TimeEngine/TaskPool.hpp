@@ -0,0 +1,59 @@
+//
+//  TaskPool.hpp
+//  Emojicode
+//
+
+#ifndef TaskPool_hpp
+#define TaskPool_hpp
+
+#include "EmojicodeAPI.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace Emojicode {
+
+struct Fiber;
+
+struct FutureState {
+    std::mutex mutex;
+    std::condition_variable condition;
+    /// Set with @c mutex locked, but also read without it by workers waiting in TaskPool::waitForTaskOrFuture().
+    std::atomic_bool done{false};
+    /// Fibers waiting for the task, which park instead of waiting on @c condition.
+    std::vector<Fiber *> waiters;
+};
+
+/// The value area of 📮.
+struct Future {
+    /// A pinned buffer that contains the FutureState.
+    Object *state;
+    /// The value returned by the task once it is done.
+    Box value;
+
+    FutureState* futureState() { return reinterpret_cast<FutureState *>(pinnedBufferBytes(state)); }
+};
+
+/// A fixed-size pool of worker threads, which is started when the first task is submitted.
+///
+/// Every worker has its own queue of tasks. A worker takes tasks from the back of its own queue and, once it is empty,
+/// steals from the front of the queues of the other workers.
+namespace TaskPool {
+    /// Schedules the task of calling @c callable and storing the returned value in @c future, an object of 📮.
+    void submit(Object *callable, Object *future);
+    /// Executes a queued task on the calling thread if it is a worker. Returns false if the calling thread is not a
+    /// worker or if there was no task.
+    /// @warning GC-invoking
+    bool runQueuedTask(Thread *thread);
+    /// Blocks the calling worker until a task is queued or the task of @c state is done.
+    void waitForTaskOrFuture(FutureState *state);
+    /// Returns true if the calling thread is a worker.
+    bool isWorker();
+    /// Marks the objects referenced by all queued tasks. Called by the garbage collector.
+    void markTasks();
+}  // namespace TaskPool
+
+}  // namespace Emojicode
+
+#endif /* TaskPool_hpp */
@@ -9,33 +9,140 @@
 #include "Thread.hpp"
 #include "Memory.hpp"
 #include "Processor.hpp"
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <sys/mman.h>
 #include <thread>
+#include <unistd.h>
+#include <vector>
 
 using namespace Emojicode;
 
-Thread::Thread() {
-#define stackSize (sizeof(StackFrame) * 1000000)
-    stackLimit_ = static_cast<StackFrame *>(calloc(stackSize, 1));
-    if (!stackLimit_) {
-        error("Could not allocate stack!");
+/// The size of the inaccessible region below every stack. A frame can only skip the guard if it is larger than this.
+const size_t stackGuardSize = 1024 * 1024;
+
+/// The stack mappings of deallocated fibers, which are handed to new fibers with stacks of the same size. Reusing a
+/// mapping saves the system calls and the page faults of committing a new one, which would otherwise dominate the cost
+/// of a short-lived fiber. The cache is never deallocated as carriers may still deallocate fibers while the program
+/// exits.
+std::mutex stackCacheMutex;
+auto stackCache = new std::vector<std::pair<Byte *, size_t>>();
+const size_t stackCacheCapacity = 256;
+
+struct sigaction defaultSegmentationFaultAction;
+std::once_flag segmentationFaultHandlerInstalled;
+
+/// The guards of the stack and of the native stack of the thread that the calling operating system thread runs. The
+/// signal handler may interrupt code that modifies the thread list and therefore only looks at these ranges, which are
+/// set by Thread::setCurrent().
+thread_local const Byte *currentStackGuard = nullptr;
+thread_local const Byte *currentStackGuardEnd = nullptr;
+thread_local const Byte *currentNativeStackGuard = nullptr;
+thread_local const Byte *currentNativeStackGuardEnd = nullptr;
+
+/// The stack on which the signal handler runs on an operating system thread that runs fibers. The handler cannot run on
+/// a native stack that overflowed.
+thread_local std::unique_ptr<Byte[]> signalStack;
+
+void Thread::setCurrent(const Thread *thread) {
+    if (thread == nullptr) {
+        currentStackGuard = currentStackGuardEnd = currentNativeStackGuard = currentNativeStackGuardEnd = nullptr;
+        return;
+    }
+    currentStackGuard = thread->stackMapping_;
+    currentStackGuardEnd = reinterpret_cast<Byte *>(thread->stackLimit_);
+    currentNativeStackGuard = reinterpret_cast<Byte *>(thread->stackBottom_);
+    currentNativeStackGuardEnd = thread->nativeStack_;
+
+    if (thread->nativeStackSize_ > 0 && !signalStack) {
+        auto size = std::max<size_t>(SIGSTKSZ, 64 * 1024);
+        signalStack = std::make_unique<Byte[]>(size);
+        stack_t alternateStack;
+        alternateStack.ss_sp = signalStack.get();
+        alternateStack.ss_size = size;
+        alternateStack.ss_flags = 0;
+        if (sigaltstack(&alternateStack, nullptr) != 0) {
+            error("Could not install the signal stack!");
+        }
+    }
+}
+
+void Thread::handleSegmentationFault(int signal, siginfo_t *info, void *context) {
+    auto address = static_cast<Byte *>(info->si_addr);
+    if ((currentStackGuard <= address && address < currentStackGuardEnd) ||
+        (currentNativeStackGuard <= address && address < currentNativeStackGuardEnd)) {
+        const char message[] = "🚨 Fatal Error: Your program triggerd a stack overflow!\n";
+        write(STDERR_FILENO, message, sizeof(message) - 1);
+        abort();
     }
-    stackBottom_ = reinterpret_cast<StackFrame *>(reinterpret_cast<Byte *>(stackLimit_) + stackSize);
+    // Not a stack overflow: Restore the default action, which is taken when the faulting instruction is retried.
+    sigaction(SIGSEGV, &defaultSegmentationFaultAction, nullptr);
+}
+
+Thread::Thread(size_t stackSize, size_t nativeStackSize) {
+    std::call_once(segmentationFaultHandlerInstalled, [] {
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_sigaction = handleSegmentationFault;
+        action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGSEGV, &action, &defaultSegmentationFaultAction);
+    });
+
+    auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    stackSize = std::max((stackSize + pageSize - 1) & ~(pageSize - 1), pageSize);
+    nativeStackSize_ = (nativeStackSize + pageSize - 1) & ~(pageSize - 1);
+    // A native stack overflowing into the stack would corrupt it silently.
+    size_t nativeStackGuardSize = nativeStackSize_ > 0 ? pageSize : 0;
+    stackMappingSize_ = stackGuardSize + stackSize + nativeStackGuardSize + nativeStackSize_;
+    stackMapping_ = nullptr;
+    if (nativeStackSize_ > 0) {
+        std::lock_guard<std::mutex> lock(stackCacheMutex);
+        auto cached = std::find_if(stackCache->rbegin(), stackCache->rend(), [this](const std::pair<Byte *, size_t> &m) {
+            return m.second == stackMappingSize_;
+        });
+        if (cached != stackCache->rend()) {
+            stackMapping_ = cached->first;
+            stackCache->erase(std::next(cached).base());
+        }
+    }
+    if (stackMapping_ == nullptr) {
+        // The pages are only committed when they are touched for the first time.
+        void *mapping = mmap(nullptr, stackMappingSize_, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (mapping == MAP_FAILED) {
+            error("Could not allocate stack!");
+        }
+        stackMapping_ = static_cast<Byte *>(mapping);
+        if (mprotect(stackMapping_, stackGuardSize, PROT_NONE) != 0 ||
+            mprotect(stackMapping_ + stackGuardSize + stackSize, nativeStackGuardSize, PROT_NONE) != 0) {
+            error("Could not protect the stack guard!");
+        }
+    }
+    stackLimit_ = reinterpret_cast<StackFrame *>(stackMapping_ + stackGuardSize);
+    stackBottom_ = reinterpret_cast<StackFrame *>(stackMapping_ + stackGuardSize + stackSize);
+    nativeStack_ = stackMapping_ + stackGuardSize + stackSize + nativeStackGuardSize;
     this->futureStack_ = this->stack_ = this->stackBottom_;
 }
 
 Thread::~Thread() {
-    free(stackLimit_);
+    if (nativeStackSize_ > 0) {
+        std::lock_guard<std::mutex> lock(stackCacheMutex);
+        if (stackCache->size() < stackCacheCapacity) {
+            stackCache->emplace_back(stackMapping_, stackMappingSize_);
+            return;
+        }
+    }
+    munmap(stackMapping_, stackMappingSize_);
 }
 
 StackFrame* Thread::reserveFrame(Value self, int size, Function *function, Value *destination,
                             EmojicodeInstruction *executionPointer) {
     size_t fullSize = sizeof(StackFrame) + sizeof(Value) * size;
+    // An overflow is detected by handleSegmentationFault when the guard pages are touched below.
     auto *sf = (StackFrame *)((Byte *)futureStack_ - (fullSize + (fullSize % alignof(StackFrame))));
-    if (sf < stackLimit_) {
-        error("Your program triggerd a stack overflow!");
-    }
 
     sf->thisContext = self;
     sf->returnPointer = stack_;
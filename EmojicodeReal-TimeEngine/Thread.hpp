@@ -12,10 +12,17 @@
 #include "Engine.hpp"
 #include "RetainedObjectPointer.hpp"
 #include "ThreadsManager.hpp"
+#include <csignal>
 #include <mutex>
 
 namespace Emojicode {
 
+struct Fiber;
+
+namespace Fibers {
+    void spawn(Object *callable, Object *state);
+}
+
 struct StackFrame {
     StackFrame *returnPointer;
     StackFrame *returnFutureStack;
@@ -31,8 +38,9 @@ struct StackFrame {
 
 class Thread {
 public:
-    friend void gc(std::unique_lock<std::mutex> &, size_t);
-    friend Thread* ThreadsManager::allocateThread();
+    friend void markRoots();
+    friend Thread* ThreadsManager::allocateThread(size_t stackSize, size_t nativeStackSize);
+    friend void Fibers::spawn(Object *callable, Object *state);
     friend void ThreadsManager::deallocateThread(Thread *thread);
     friend Thread* ThreadsManager::nextThread(Thread *thread);
 
@@ -51,6 +59,13 @@ public:
 
     StackFrame* currentStackFrame() const { return stack_; }
 
+    /// Returns the fiber this thread belongs to or @c nullptr if this thread is run by an operating system thread.
+    Fiber* fiber() const { return fiber_; }
+
+    /// Tells the signal handler that the calling operating system thread now runs @c thread, so that a segmentation
+    /// fault in the guard of its stack is reported as stack overflow. Pass @c nullptr when it stops running it.
+    static void setCurrent(const Thread *thread);
+
     /// Returns the content of the variable slot at the specific index from the stack associated with this thread
     Value variable(int index) const { return *variableDestination(index); }
     /// Returns a pointer to the variable slot at the specific index from the stack associated with this thread
@@ -118,9 +133,12 @@ public:
         return RetainedObjectPointer(&variableDestination(index)->object);
     }
 private:
-    Thread();
+    Thread(size_t stackSize, size_t nativeStackSize);
     ~Thread();
 
+    /// Reports a stack overflow if a segmentation fault was caused by an access to the guard page of a stack.
+    static void handleSegmentationFault(int signal, siginfo_t *info, void *context);
+
     void markStack();
     void markRetainList() {
         for (Object **pointer = retainList; pointer < retainPointer; pointer++) {
@@ -128,8 +146,16 @@ private:
         }
     }
 
+    /// The memory mapping of the stack, which begins with the guard pages. The stack grows down towards them. The
+    /// native stack, if any, follows the stack after another guard page at @c stackBottom_ and begins at
+    /// @c nativeStack_.
+    Byte *stackMapping_;
+    size_t stackMappingSize_;
     StackFrame *stackLimit_;
     StackFrame *stackBottom_;
+    Byte *nativeStack_;
+    size_t nativeStackSize_;
+    Fiber *fiber_ = nullptr;
     StackFrame *stack_;
     StackFrame *futureStack_;
 
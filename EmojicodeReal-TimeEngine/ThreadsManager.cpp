@@ -7,6 +7,7 @@
 //
 
 #include "ThreadsManager.hpp"
+#include "Memory.hpp"
 #include "Thread.hpp"
 #include <atomic>
 
@@ -28,9 +29,9 @@ Thread* Emojicode::ThreadsManager::nextThread(Thread *thread) {
     return thread->threadBefore_;
 }
 
-Thread* Emojicode::ThreadsManager::allocateThread() {
+Thread* Emojicode::ThreadsManager::allocateThread(size_t stackSize, size_t nativeStackSize) {
+    auto thread = new Thread(stackSize, nativeStackSize);
     std::lock_guard<std::mutex> threadListLock(threadListMutex);
-    auto thread = new Thread;
     thread->threadBefore_ = lastThread_;
     thread->threadAfter_ = nullptr;
     if (lastThread_ != nullptr) {
@@ -42,20 +43,23 @@ Thread* Emojicode::ThreadsManager::allocateThread() {
 }
 
 void Emojicode::ThreadsManager::deallocateThread(Thread *thread) {
-    std::lock_guard<std::mutex> threadListLock(threadListMutex);
-    Thread *before = thread->threadBefore_;
-    Thread *after = thread->threadAfter_;
+    {
+        std::lock_guard<std::mutex> threadListLock(threadListMutex);
+        Thread *before = thread->threadBefore_;
+        Thread *after = thread->threadAfter_;
 
-    if (before != nullptr) {
-        before->threadAfter_ = after;
-    }
-    if (after != nullptr) {
-        after->threadBefore_ = before;
-    }
-    else {
-        lastThread_ = before;
-    }
+        if (before != nullptr) {
+            before->threadAfter_ = after;
+        }
+        if (after != nullptr) {
+            after->threadBefore_ = before;
+        }
+        else {
+            lastThread_ = before;
+        }
 
-    delete thread;
-    threads_--;
+        delete thread;
+        threads_--;
+    }
+    threadTerminated();
 }
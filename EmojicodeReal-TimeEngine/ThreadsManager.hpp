@@ -9,16 +9,22 @@
 #ifndef ThreadsManager_hpp
 #define ThreadsManager_hpp
 
+#include <cstddef>
 #include <mutex>
 
 namespace Emojicode {
 
 class Thread;
 
+/// The stack size of threads for which no other size was requested. Only the pages actually used are committed.
+constexpr size_t defaultStackSize = 64 * 1024 * 1024;
+
 /// This class is responsible for allocating threads and to give the garbage collector information about the threads
 namespace ThreadsManager {
     extern std::mutex threadListMutex;
-    Thread* allocateThread();
+    /// Allocates a new thread with a stack of @c stackSize bytes. If @c nativeStackSize is not zero, a native stack of
+    /// that size, on which the thread can be run with a context of its own, is reserved along with it.
+    Thread* allocateThread(size_t stackSize = defaultStackSize, size_t nativeStackSize = 0);
     void deallocateThread(Thread *thread);
     Thread* anyThread();
     Thread* nextThread(Thread *thread);
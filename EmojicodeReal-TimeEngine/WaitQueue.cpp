@@ -0,0 +1,38 @@
+//
+//  WaitQueue.cpp
+//  Emojicode
+//
+
+#include "WaitQueue.hpp"
+#include "Memory.hpp"
+#include "Thread.hpp"
+#include <algorithm>
+
+namespace Emojicode {
+
+void lockBlocking(std::unique_lock<std::mutex> &lock) {
+    if (!lock.try_lock()) {
+        BlockingRegion region;
+        lock.lock();
+    }
+}
+
+void waitOnQueue(Thread *thread, std::unique_lock<std::mutex> &lock, WaitQueue &queue) {
+    if (thread->fiber() == nullptr) {
+        BlockingRegion region;
+        queue.condition.wait(lock);
+        return;
+    }
+    Waiter waiter;
+    waiter.fiber = thread->fiber();
+    queue.fibers.push_back(&waiter);
+    lock.unlock();
+    Fibers::park(thread);
+    lockBlocking(lock);
+    // The queue removes the waiter when it signals it, which happens with the mutex locked.
+    if (!waiter.signaled) {
+        queue.fibers.erase(std::find(queue.fibers.begin(), queue.fibers.end(), &waiter));
+    }
+}
+
+}  // namespace Emojicode
@@ -0,0 +1,74 @@
+//
+//  WaitQueue.hpp
+//  Emojicode
+//
+
+#ifndef WaitQueue_hpp
+#define WaitQueue_hpp
+
+#include "EmojicodeAPI.hpp"
+#include "Fiber.hpp"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace Emojicode {
+
+/// A thread waiting in a select on several channels at once, or a fiber waiting in a WaitQueue. The channels signal a
+/// select whenever an item arrives or they are closed.
+struct Waiter {
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool signaled = false;
+    /// The fiber to unpark, if the waiter is a fiber.
+    Fiber *fiber = nullptr;
+
+    void signal() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            signaled = true;
+        }
+        if (fiber != nullptr) {
+            Fibers::unpark(fiber);
+        }
+        else {
+            condition.notify_one();
+        }
+    }
+};
+
+/// Threads waiting for a change of some state block on @c condition. Fibers must not block their carrier and park in
+/// @c fibers instead. Guarded by the mutex that guards the state, which must be locked to notify the queue.
+struct WaitQueue {
+    std::condition_variable condition;
+    std::deque<Waiter *> fibers;
+
+    void notifyOne() {
+        condition.notify_one();
+        if (!fibers.empty()) {
+            fibers.front()->signal();
+            fibers.pop_front();
+        }
+    }
+
+    void notifyAll() {
+        condition.notify_all();
+        for (auto waiter : fibers) {
+            waiter->signal();
+        }
+        fibers.clear();
+    }
+};
+
+/// Locks @c lock, inside a BlockingRegion if the mutex is contended. A thread may therefore hold the mutex while it is
+/// paused for garbage collection without stalling the collector. Heap pointers must be read again afterwards.
+/// @warning GC-invoking
+void lockBlocking(std::unique_lock<std::mutex> &lock);
+
+/// Waits until @c queue is notified, which may also happen spuriously. @c lock must hold the mutex guarding the queue.
+/// @warning GC-invoking
+void waitOnQueue(Thread *thread, std::unique_lock<std::mutex> &lock, WaitQueue &queue);
+
+}  // namespace Emojicode
+
+#endif /* WaitQueue_hpp */
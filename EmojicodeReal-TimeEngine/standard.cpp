@@ -8,22 +8,32 @@
 
 #include "standard.h"
 #include "../utf8.h"
+#include "Channel.h"
+#include "ConcurrentQueue.h"
 #include "Dictionary.h"
 #include "Engine.hpp"
+#include "Fiber.hpp"
 #include "List.h"
+#include "PrimitiveArray.hpp"
 #include "String.h"
 #include "String.h"
+#include "TaskPool.hpp"
 #include "Thread.hpp"
 #include "Memory.hpp"
 #include "ThreadsManager.hpp"
+#include "WaitQueue.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <cmath>
+#include <condition_variable>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
-#include <pthread.h>
+#include <mutex>
+#include <new>
 #include <random>
+#include <string>
 #include <thread>
 #include <unistd.h>
 
@@ -59,13 +69,17 @@ static void systemArgs(Thread *thread) {
     auto listObject = thread->retain(newObject(CL_LIST));
 
     auto *newList = listObject->val<List>();
+    newList->count = 0;
+    newList->capacity = 0;
+    newList->items = nullptr;
+    Object *items = newArray(sizeof(Box) * cliArgumentCount);
+    newList = listObject->val<List>();
     newList->capacity = cliArgumentCount;
-    Object *items = newArray(sizeof(Value) * cliArgumentCount);
-
-    listObject->val<List>()->items = items;
+    newList->items = items;
 
     for (int i = 0; i < cliArgumentCount; i++) {
-        listAppendDestination(listObject, thread)->copySingleValue(T_OBJECT, stringFromChar(cliArguments[i]));
+        Object *argument = stringFromChar(cliArguments[i]);
+        listAppendDestination(listObject, thread)->copySingleValue(T_OBJECT, argument);
     }
 
     thread->release(1);
@@ -73,95 +87,318 @@ static void systemArgs(Thread *thread) {
 }
 
 static void systemSystem(Thread *thread) {
-    FILE *f = popen(stringToCString(thread->variable(0).object), "r");
+    std::string command = stringToCString(thread->variable(0).object);
+    std::string output;
+    bool success;
+
+    {
+        BlockingRegion region;
+        FILE *f = popen(command.c_str(), "r");
+        success = f != nullptr;
+        if (success) {
+            char buffer[4096];
+            size_t read;
+            while ((read = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+                output.append(buffer, read);
+            }
+            pclose(f);
+        }
+    }
 
-    if (f == nullptr) {
+    if (!success) {
         thread->returnNothingnessFromFunction();
         return;
     }
 
-    size_t bufferUsedSize = 0;
-    int bufferSize = 50;
-    auto buffer = thread->retain(newArray(bufferSize));
-
-    while (fgets(buffer->val<char>() + bufferUsedSize, bufferSize - (int)bufferUsedSize, f) != nullptr) {
-        bufferUsedSize = strlen(buffer->val<char>());
-
-        if (bufferSize - bufferUsedSize < 2) {
-            bufferSize *= 2;
-            buffer = resizeArray(buffer.unretainedPointer(), bufferSize, thread);
-        }
-    }
-
-    bufferUsedSize = strlen(buffer->val<char>());
-
-    EmojicodeInteger len = u8_strlen_l(buffer->val<char>(), bufferUsedSize);
-
-    auto so = thread->retain(newObject(CL_STRING));
-    auto *string = so->val<String>();
-    string->length = len;
-
-    Object *chars = newArray(len * sizeof(EmojicodeChar));
-    string = so->val<String>();
-    string->charactersObject = chars;
-
-    u8_toucs(string->characters(), len, buffer->val<char>(), bufferUsedSize);
-    thread->release(2);
-    thread->returnFromFunction(so.unretainedPointer());
+    thread->returnOEValueFromFunction(stringFromUTF8(output.data(), output.size(), thread));
 }
 
 //MARK: Threads
 
 static void threadJoin(Thread *thread) {
     auto cthread = *thread->thisObject()->val<std::thread*>();
-    allowGC();
-    cthread->join();
-    disallowGCAndPauseIfNeeded();
+    {
+        BlockingRegion region;
+        cthread->join();
+    }
     thread->returnFromFunction();
 }
 
 static void threadSleepMicroseconds(Thread *thread) {
-    std::this_thread::sleep_for(std::chrono::microseconds(thread->variable(0).raw));
+    auto duration = std::chrono::microseconds(thread->variable(0).raw);
+    if (thread->fiber() != nullptr) {
+        Fibers::sleepUntil(thread, std::chrono::steady_clock::now() + duration);
+    }
+    else {
+        BlockingRegion region;
+        std::this_thread::sleep_for(duration);
+    }
     thread->returnFromFunction();
 }
 
 void threadStart(Thread *thread, RetainedObjectPointer callable) {
+    Thread::setCurrent(thread);
     thread->release(1);
     executeCallableExtern(callable.unretainedPointer(), nullptr, 0, thread, nullptr);
+    Thread::setCurrent(nullptr);
     ThreadsManager::deallocateThread(thread);
 }
 
-static void initThread(Thread *thread) {
-    auto newThread = ThreadsManager::allocateThread();
+static void startThread(Thread *thread, size_t stackSize) {
+    auto newThread = ThreadsManager::allocateThread(stackSize);
     auto callable = thread->variable(0).object;
     // TODO: leak below
     *thread->thisObject()->val<std::thread*>() = new std::thread(threadStart, newThread, newThread->retain(callable));
     thread->returnFromFunction(thread->thisContext());
 }
 
+static void initThread(Thread *thread) {
+    startThread(thread, defaultStackSize);
+}
+
+static void initThreadWithStackSize(Thread *thread) {
+    EmojicodeInteger stackSize = thread->variable(1).raw;
+    startThread(thread, stackSize > 0 ? static_cast<size_t>(stackSize) : defaultStackSize);
+}
+
+// The synchronization primitives below are kept in pinned buffers, which are referenced from the value area of their
+// objects. As they are never moved, a thread can block on them inside a BlockingRegion and thereby allow the garbage
+// collector to run while it waits.
+
+/// Returns the native object stored in the pinned buffer of @c object.
+template <typename T>
+static T* pinnedValue(Object *object) {
+    return reinterpret_cast<T *>(pinnedBufferBytes(*object->val<Object *>()));
+}
+
+/// Constructs a T from @c args in a new pinned buffer and stores the buffer in the this-object.
+template <typename T, typename... Args>
+static void initPinnedValue(Thread *thread, Args... args) {
+    Object *buffer = newPinnedBuffer(sizeof(T), [](char *bytes) { reinterpret_cast<T *>(bytes)->~T(); });
+    new (pinnedBufferBytes(buffer)) T(args...);
+    *thread->thisObject()->val<Object *>() = buffer;
+}
+
+static void pinnedValueMark(Object *o) {
+    if (*o->val<Object *>() != nullptr) {
+        mark(o->val<Object *>());
+    }
+}
+
+/// The state of a 🔐. Unlike a std::mutex it can be unlocked on another operating system thread than it was locked on,
+/// which happens when a fiber holding it is resumed by another carrier, and fibers waiting for it park. @c mutex only
+/// guards the state and is never held while Emojicode code runs.
+struct Mutex {
+    std::mutex mutex;
+    WaitQueue unlocked;
+    bool locked = false;
+};
+
 static void initMutex(Thread *thread) {
-    pthread_mutex_init(thread->thisObject()->val<pthread_mutex_t>(), nullptr);
+    initPinnedValue<Mutex>(thread);
     thread->returnFromFunction(thread->thisContext());
 }
 
-static void mutexLock(Thread *thread) {
-    while (pthread_mutex_trylock(thread->thisObject()->val<pthread_mutex_t>()) != 0) {
-        // TODO: Obviously stupid, but this is the only safe way. If pthread_mutex_lock was used,
-        // the thread would be block, and the GC could cause a deadlock. allowGC, however, would
-        // allow moving this mutex – obviously not a good idea either when using pthread_mutex_lock.
-        pauseForGC();
-        usleep(10);
+static void lockMutex(Thread *thread, Mutex *mutex) {
+    std::unique_lock<std::mutex> lock(mutex->mutex, std::defer_lock);
+    lockBlocking(lock);
+    while (mutex->locked) {
+        waitOnQueue(thread, lock, mutex->unlocked);
     }
+    mutex->locked = true;
+}
+
+static void unlockMutex(Mutex *mutex) {
+    std::unique_lock<std::mutex> lock(mutex->mutex, std::defer_lock);
+    lockBlocking(lock);
+    mutex->locked = false;
+    mutex->unlocked.notifyOne();
+}
+
+static void mutexLock(Thread *thread) {
+    lockMutex(thread, pinnedValue<Mutex>(thread->thisObject()));
     thread->returnFromFunction();
 }
 
 static void mutexUnlock(Thread *thread) {
-    pthread_mutex_unlock(thread->thisObject()->val<pthread_mutex_t>());
+    unlockMutex(pinnedValue<Mutex>(thread->thisObject()));
     thread->returnFromFunction();
 }
 
 static void mutexTryLock(Thread *thread) {
-    thread->returnFromFunction(pthread_mutex_trylock(thread->thisObject()->val<pthread_mutex_t>()) == 0);
+    auto mutex = pinnedValue<Mutex>(thread->thisObject());
+    std::unique_lock<std::mutex> lock(mutex->mutex, std::defer_lock);
+    lockBlocking(lock);
+    bool acquired = !mutex->locked;
+    mutex->locked = true;
+    thread->returnFromFunction(acquired);
+}
+
+/// The state of a 🚦. Waiters register while holding @c mutex before they unlock their 🔐, so that no notification
+/// sent after the 🔐 was unlocked is missed.
+struct ConditionVariable {
+    std::mutex mutex;
+    WaitQueue notified;
+};
+
+static void initConditionVariable(Thread *thread) {
+    initPinnedValue<ConditionVariable>(thread);
+    thread->returnFromFunction(thread->thisContext());
+}
+
+static void conditionVariableWait(Thread *thread) {
+    auto condition = pinnedValue<ConditionVariable>(thread->thisObject());
+    auto mutex = pinnedValue<Mutex>(thread->variable(0).object);
+    {
+        std::unique_lock<std::mutex> lock(condition->mutex, std::defer_lock);
+        lockBlocking(lock);
+        unlockMutex(mutex);
+        waitOnQueue(thread, lock, condition->notified);
+    }
+    lockMutex(thread, mutex);
+    thread->returnFromFunction();
+}
+
+static void conditionVariableNotifyOne(Thread *thread) {
+    auto condition = pinnedValue<ConditionVariable>(thread->thisObject());
+    std::unique_lock<std::mutex> lock(condition->mutex, std::defer_lock);
+    lockBlocking(lock);
+    condition->notified.notifyOne();
+    thread->returnFromFunction();
+}
+
+static void conditionVariableNotifyAll(Thread *thread) {
+    auto condition = pinnedValue<ConditionVariable>(thread->thisObject());
+    std::unique_lock<std::mutex> lock(condition->mutex, std::defer_lock);
+    lockBlocking(lock);
+    condition->notified.notifyAll();
+    thread->returnFromFunction();
+}
+
+struct Semaphore {
+    explicit Semaphore(EmojicodeInteger value) : value(value) {}
+    std::mutex mutex;
+    WaitQueue released;
+    EmojicodeInteger value;
+};
+
+static void initSemaphore(Thread *thread) {
+    initPinnedValue<Semaphore>(thread, thread->variable(0).raw);
+    thread->returnFromFunction(thread->thisContext());
+}
+
+static void semaphoreAcquire(Thread *thread) {
+    auto semaphore = pinnedValue<Semaphore>(thread->thisObject());
+    std::unique_lock<std::mutex> lock(semaphore->mutex, std::defer_lock);
+    lockBlocking(lock);
+    while (semaphore->value <= 0) {
+        waitOnQueue(thread, lock, semaphore->released);
+    }
+    semaphore->value--;
+    thread->returnFromFunction();
+}
+
+static void semaphoreRelease(Thread *thread) {
+    auto semaphore = pinnedValue<Semaphore>(thread->thisObject());
+    std::unique_lock<std::mutex> lock(semaphore->mutex, std::defer_lock);
+    lockBlocking(lock);
+    semaphore->value++;
+    semaphore->released.notifyOne();
+    thread->returnFromFunction();
+}
+
+static void initFuture(Thread *thread) {
+    auto future = thread->thisObject()->val<Future>();
+    future->state = nullptr;
+    future->value.makeNothingness();
+    Object *state = newPinnedBuffer(sizeof(FutureState), [](char *bytes) {
+        reinterpret_cast<FutureState *>(bytes)->~FutureState();
+    });
+    new (pinnedBufferBytes(state)) FutureState();
+    thread->thisObject()->val<Future>()->state = state;
+    TaskPool::submit(thread->variable(0).object, thread->thisObject());
+    thread->returnFromFunction(thread->thisContext());
+}
+
+static void futureWait(Thread *thread) {
+    FutureState *state = thread->thisObject()->val<Future>()->futureState();
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            if (state->done) {
+                break;
+            }
+            if (Fiber *fiber = thread->fiber()) {
+                state->waiters.push_back(fiber);
+                lock.unlock();
+                Fibers::park(thread);
+                lock.lock();
+                state->waiters.erase(std::remove(state->waiters.begin(), state->waiters.end(), fiber),
+                                     state->waiters.end());
+                continue;
+            }
+        }
+        // A worker must not block on a task that might be queued behind it, so it helps with the queued tasks and
+        // is woken by new ones.
+        if (TaskPool::runQueuedTask(thread)) {
+            continue;
+        }
+        if (TaskPool::isWorker()) {
+            TaskPool::waitForTaskOrFuture(state);
+            continue;
+        }
+        BlockingRegion region;
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->condition.wait(lock, [state] { return state->done.load(); });
+    }
+    thread->thisObject()->val<Future>()->value.copyTo(thread->currentStackFrame()->destination);
+    thread->returnFromFunction();
+}
+
+static void futureIsDone(Thread *thread) {
+    FutureState *state = thread->thisObject()->val<Future>()->futureState();
+    std::lock_guard<std::mutex> lock(state->mutex);
+    thread->returnFromFunction(state->done.load());
+}
+
+// Unlike the primitives above, atomic integers are stored right in the value area: No thread can be paused in the
+// middle of an atomic operation, so the garbage collector can move them like any other value.
+
+static std::atomic<EmojicodeInteger>* atomicInteger(Thread *thread) {
+    return thread->thisObject()->val<std::atomic<EmojicodeInteger>>();
+}
+
+static void initAtomicInteger(Thread *thread) {
+    new (atomicInteger(thread)) std::atomic<EmojicodeInteger>(thread->variable(0).raw);
+    thread->returnFromFunction(thread->thisContext());
+}
+
+static void atomicIntegerLoad(Thread *thread) {
+    thread->returnFromFunction(atomicInteger(thread)->load());
+}
+
+static void atomicIntegerStore(Thread *thread) {
+    atomicInteger(thread)->store(thread->variable(0).raw);
+    thread->returnFromFunction();
+}
+
+static void atomicIntegerFetchAdd(Thread *thread) {
+    thread->returnFromFunction(atomicInteger(thread)->fetch_add(thread->variable(0).raw));
+}
+
+static void atomicIntegerCompareExchange(Thread *thread) {
+    EmojicodeInteger expected = thread->variable(0).raw;
+    thread->returnFromFunction(atomicInteger(thread)->compare_exchange_strong(expected, thread->variable(1).raw));
+}
+
+static void futureMark(Object *o) {
+    auto future = o->val<Future>();
+    if (future->state != nullptr) {
+        mark(&future->state);
+    }
+    if (future->value.type.raw == T_OBJECT || (future->value.type.raw & REMOTE_MASK) != 0) {
+        mark(&future->value.value1.object);
+    }
 }
 
 // MARK: Data
@@ -185,8 +422,11 @@ static void dataSize(Thread *thread) {
 static void dataMark(Object *o) {
     auto *d = o->val<Data>();
     if (d->bytesObject) {
+        auto offset = d->bytes - d->bytesObject->val<char>();
         mark(&d->bytesObject);
-        d->bytes = d->bytesObject->val<char>();
+        if (!d->pinned()) {
+            d->bytes = d->bytesObject->val<char>() + offset;
+        }
     }
 }
 
@@ -207,20 +447,22 @@ static void dataGetByte(Thread *thread) {
 
 static void dataToString(Thread *thread) {
     auto *data = thread->thisObject()->val<Data>();
-    if (u8_isvalid(data->bytes, data->length) == 0) {
+    int validity = u8_isvalid(data->bytes, data->length);
+    if (validity == 0) {
         thread->returnNothingnessFromFunction();
         return;
     }
 
-    EmojicodeInteger len = u8_strlen_l(data->bytes, data->length);
-    auto characters = thread->retain(newArray(len * sizeof(EmojicodeChar)));
+    // ASCII data need not be measured again.
+    EmojicodeInteger len = data->length;
+    bool compact = true;
+    if (validity != 1) {
+        measureUTF8(data->bytes, data->length, &len, &compact);
+    }
 
-    Object *sto = newObject(CL_STRING);
-    auto *string = sto->val<String>();
-    string->length = len;
-    string->charactersObject = characters.unretainedPointer();
-    thread->release(1);
-    u8_toucs(string->characters(), len, data->bytes, data->length);
+    Object *sto = newString(len, compact, thread);
+    data = thread->thisObject()->val<Data>();
+    decodeUTF8(sto->val<String>(), data->bytes, data->length);
     thread->returnOEValueFromFunction(sto);
 }
 
@@ -285,30 +527,11 @@ static void dataByAppendingData(Thread *thread) {
 
 void integerToString(Thread *thread) {
     EmojicodeInteger base = thread->variable(0).raw;
-    EmojicodeInteger n = thread->thisContext().value->raw, a = std::abs(n);
-    bool negative = n < 0;
-
-    EmojicodeInteger d = negative ? 2 : 1;
-    while (n /= base) {
-        d++;
-    }
+    EmojicodeInteger n = thread->thisContext().value->raw;
+    EmojicodeInteger d = integerCharacterCount(n, base);
 
-    auto co = thread->retain(newArray(d * sizeof(EmojicodeChar)));
-
-    Object *stringObject = newObject(CL_STRING);
-    auto *string = stringObject->val<String>();
-    string->length = d;
-    string->charactersObject = co.unretainedPointer();
-
-    EmojicodeChar *characters = string->characters() + d;
-    do {
-        *--characters =  "0123456789abcdefghijklmnopqrstuvxyz"[a % base % 35];
-    } while (a /= base);
-
-    if (negative) {
-        characters[-1] = '-';
-    }
-    thread->release(1);
+    Object *stringObject = newString(d, true, thread);
+    writeInteger(n, base, stringObject->val<String>()->compactCharacters() + d);
     thread->returnFromFunction(stringObject);
 }
 
@@ -332,13 +555,15 @@ static void integerAbsolute(Thread *thread) {
 }
 
 static void symbolToString(Thread *thread) {
-    auto co = thread->retain(newArray(sizeof(EmojicodeChar)));
-    Object *stringObject = newObject(CL_STRING);
+    EmojicodeChar symbol = thread->thisContext().value->character;
+    Object *stringObject = newString(1, symbol <= compactCharacterMax, thread);
     auto *string = stringObject->val<String>();
-    string->length = 1;
-    string->charactersObject = co.unretainedPointer();
-    thread->release(1);
-    string->characters()[0] = thread->thisContext().value->character;
+    if (string->compact) {
+        string->compactCharacters()[0] = symbol;
+    }
+    else {
+        string->characters()[0] = symbol;
+    }
     thread->returnFromFunction(stringObject);
 }
 
@@ -349,44 +574,10 @@ static void symbolToInteger(Thread *thread) {
 static void doubleToString(Thread *thread) {
     EmojicodeInteger precision = thread->variable(0).raw;
     double d = thread->thisContext().value->doubl;
-    double absD = std::abs(d);
-
-    bool negative = d < 0;
-
-    EmojicodeInteger length = negative ? 1 : 0;
-    if (precision != 0) {
-        length++;
-    }
-    length += precision;
-    EmojicodeInteger iLength = 1;
-    for (size_t i = 1; pow(10, i) < absD; i++) {
-        iLength++;
-    }
-    length += iLength;
+    EmojicodeInteger length = doubleCharacterCount(d, precision);
 
-    auto co = thread->retain(newArray(length * sizeof(EmojicodeChar)));
-    Object *stringObject = newObject(CL_STRING);
-    auto *string = stringObject->val<String>();
-    string->length = length;
-    string->charactersObject = co.unretainedPointer();
-    thread->release(1);
-    EmojicodeChar *characters = string->characters() + length;
-
-    for (size_t i = precision; i > 0; i--) {
-        *--characters = static_cast<unsigned char>(fmod(absD * pow(10, i), 10.0)) % 10 + '0';
-    }
-
-    if (precision != 0) {
-        *--characters = '.';
-    }
-
-    for (size_t i = 0; i < iLength; i++) {
-        *--characters =  static_cast<unsigned char>(fmod(absD / pow(10, i), 10.0)) % 10 + '0';
-    }
-
-    if (negative) {
-        characters[-1] = '-';
-    }
+    Object *stringObject = newString(length, true, thread);
+    writeDouble(d, precision, stringObject->val<String>()->compactCharacters() + length);
     thread->returnFromFunction(stringObject);
 }
 
@@ -446,6 +637,45 @@ static void doubleAbsolute(Thread *thread) {
     thread->returnFromFunction(fabs(thread->thisContext().value->doubl));
 }
 
+//MARK: Fibers
+
+static void initFiber(Thread *thread) {
+    initPinnedValue<FiberState>(thread);
+    Fibers::spawn(thread->variable(0).object, *thread->thisObject()->val<Object *>());
+    thread->returnFromFunction(thread->thisContext());
+}
+
+static void fiberJoin(Thread *thread) {
+    auto state = pinnedValue<FiberState>(thread->thisObject());
+    if (Fiber *fiber = thread->fiber()) {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        while (!state->finished) {
+            state->joiners.push_back(fiber);
+            lock.unlock();
+            Fibers::park(thread);
+            lock.lock();
+            state->joiners.erase(std::remove(state->joiners.begin(), state->joiners.end(), fiber),
+                                 state->joiners.end());
+        }
+    }
+    else {
+        BlockingRegion region;
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->condition.wait(lock, [state] { return state->finished; });
+    }
+    thread->returnFromFunction();
+}
+
+static void fiberYield(Thread *thread) {
+    if (thread->fiber() != nullptr) {
+        Fibers::yield(thread);
+    }
+    else {
+        std::this_thread::yield();
+    }
+    thread->returnFromFunction();
+}
+
 // MARK: Callable
 
 static void closureMark(Object *o) {
@@ -453,11 +683,17 @@ static void closureMark(Object *o) {
     if (c->thisContext.object != nullptr) {
         mark(&c->thisContext.object);
     }
+    if (c->capturesInformation != nullptr) {
+        mark(&c->capturesInformation);
+    }
+    if (c->capturedVariables == nullptr || c->objectVariableRecords == nullptr) {
+        return;
+    }
     mark(&c->capturedVariables);
-    mark(&c->capturesInformation);
+    mark(&c->objectVariableRecords);
 
     auto value = c->capturedVariables->val<Value>();
-    auto records = c->capturesInformation->val<ObjectVariableRecord>();
+    auto records = c->objectVariableRecords->val<ObjectVariableRecord>();
     for (size_t i = 0; i < c->recordsCount; i++) {
         markByObjectVariableRecord(records[i], value, i);
     }
@@ -567,6 +803,135 @@ FunctionFunctionPointer sLinkingTable[] = {
     initPrngWithoutSeed,
     prngIntegerUniform,
     prngDoubleUniform,
+    //🚦
+    initConditionVariable,
+    conditionVariableWait,  // ⏳
+    conditionVariableNotifyOne,  // 🔔
+    conditionVariableNotifyAll,  // 📣
+    //🎫
+    initSemaphore,
+    semaphoreAcquire,  // 🔒
+    semaphoreRelease,  // 🔓
+    //📮
+    initFuture,
+    futureWait,  // ⏳
+    futureIsDone,  // ❓
+    initThreadWithStackSize,
+    //🔢
+    initAtomicInteger,
+    atomicIntegerLoad,  // 🐽
+    atomicIntegerStore,  // 🐷
+    atomicIntegerFetchAdd,  // 🆙
+    atomicIntegerCompareExchange,  // 🔄
+    //🚡
+    initConcurrentQueue,
+    concurrentQueueEnqueue,  // 🐻
+    concurrentQueueDequeue,  // 🐼
+    //📡
+    initChannel,
+    channelSend,  // 📤
+    channelReceive,  // 📥
+    channelClose,  // 🚪
+    channelSelect,  // 🔀
+    //🐜
+    initFiber,
+    fiberJoin,  // 🛂
+    fiberYield,  // ⏭
+    //📒
+    initDictionaryBridge,
+    bridgeIntegerDictionaryGet,  //🐽
+    bridgeIntegerDictionaryRemove,  //🐨
+    bridgeIntegerDictionarySet,  //🐷
+    bridgeIntegerDictionaryKeys,  //🐙
+    bridgeDictionaryClear,  //🐗
+    bridgeIntegerDictionaryContains,  //🐣
+    bridgeDictionarySize,  //🐔
+    //🔖
+    initDictionaryBridge,
+    bridgeSymbolDictionaryGet,  //🐽
+    bridgeSymbolDictionaryRemove,  //🐨
+    bridgeSymbolDictionarySet,  //🐷
+    bridgeSymbolDictionaryKeys,  //🐙
+    bridgeDictionaryClear,  //🐗
+    bridgeSymbolDictionaryContains,  //🐣
+    bridgeDictionarySize,  //🐔
+    bridgeDictionaryEnumerator,  //🍯🍡
+    bridgeIntegerDictionaryEnumerator,  //📒🍡
+    bridgeSymbolDictionaryEnumerator,  //🔖🍡
+    //🔭
+    dictionaryEnumeratorNext,  //🔽
+    dictionaryEnumeratorHasNext,  //❓
+    dictionaryEnumeratorKey,  //🔑
+    dictionaryEnumeratorValue,  //💎
+    //🏗
+    stringBuilderInit,
+    stringBuilderInitWithCapacity,
+    stringBuilderAppendString,  //🐻
+    stringBuilderAppendSymbol,  //📝
+    stringBuilderAppendInteger,  //🚂
+    stringBuilderAppendDouble,  //🚀
+    stringBuilderLength,  //🐔
+    stringBuilderToString,  //🔡
+    //📊
+    IntegerArrayBridges::init,
+    IntegerArrayBridges::initWithCapacity,
+    IntegerArrayBridges::initFilled,
+    IntegerArrayBridges::initFromList,
+    IntegerArrayBridges::count,  //🐔
+    IntegerArrayBridges::get,  //🐽
+    IntegerArrayBridges::set,  //🐷
+    IntegerArrayBridges::append,  //🐻
+    IntegerArrayBridges::removeAll,  //🐗
+    IntegerArrayBridges::fill,  //🎨
+    IntegerArrayBridges::copy,  //📋
+    IntegerArrayBridges::slice,  //🔪
+    IntegerArrayBridges::sum,  //💰
+    IntegerArrayBridges::minimum,  //🐁
+    IntegerArrayBridges::maximum,  //🐘
+    IntegerArrayBridges::indexOf,  //🔍
+    //📈
+    DoubleArrayBridges::init,
+    DoubleArrayBridges::initWithCapacity,
+    DoubleArrayBridges::initFilled,
+    DoubleArrayBridges::initFromList,
+    DoubleArrayBridges::count,  //🐔
+    DoubleArrayBridges::get,  //🐽
+    DoubleArrayBridges::set,  //🐷
+    DoubleArrayBridges::append,  //🐻
+    DoubleArrayBridges::removeAll,  //🐗
+    DoubleArrayBridges::fill,  //🎨
+    DoubleArrayBridges::copy,  //📋
+    DoubleArrayBridges::slice,  //🔪
+    DoubleArrayBridges::sum,  //💰
+    DoubleArrayBridges::minimum,  //🐁
+    DoubleArrayBridges::maximum,  //🐘
+    DoubleArrayBridges::indexOf,  //🔍
+    //💾
+    ByteArrayBridges::init,
+    ByteArrayBridges::initWithCapacity,
+    ByteArrayBridges::initFilled,
+    ByteArrayBridges::initFromList,
+    ByteArrayBridges::count,  //🐔
+    ByteArrayBridges::get,  //🐽
+    ByteArrayBridges::set,  //🐷
+    ByteArrayBridges::append,  //🐻
+    ByteArrayBridges::removeAll,  //🐗
+    ByteArrayBridges::fill,  //🎨
+    ByteArrayBridges::copy,  //📋
+    ByteArrayBridges::slice,  //🔪
+    ByteArrayBridges::sum,  //💰
+    ByteArrayBridges::minimum,  //🐁
+    ByteArrayBridges::maximum,  //🐘
+    ByteArrayBridges::indexOf,  //🔍
+    byteArrayInitFromData,
+    byteArrayToData,  //📇
+    //🍨
+    listSortNatural,  //🐑
+    listSortByKey,  //🐏
+    listSortStable,  //🐎
+    IntegerArrayBridges::sort,  //📊 🐑
+    DoubleArrayBridges::sort,  //📈 🐑
+    ByteArrayBridges::sort,  //💾 🐑
 };
 
 uint_fast32_t sizeForClass(Class *cl, EmojicodeChar name) {
@@ -576,7 +941,17 @@ uint_fast32_t sizeForClass(Class *cl, EmojicodeChar name) {
         case 0x1F368:
             return sizeof(List);
         case 0x1F36F:
+        case 0x1f4d2:  //📒
+        case 0x1f516:  //🔖
             return sizeof(EmojicodeDictionary);
+        case 0x1f52d:  //🔭
+            return sizeof(EmojicodeDictionaryEnumerator);
+        case 0x1f3d7:  //🏗
+            return sizeof(StringBuilder);
+        case 0x1f4ca:  //📊
+        case 0x1f4c8:  //📈
+        case 0x1f4be:  //💾
+            return sizeof(PrimitiveArray);
         case 0x1F4C7:
             return sizeof(Data);
         case 0x1F347:
@@ -584,7 +959,18 @@ uint_fast32_t sizeForClass(Class *cl, EmojicodeChar name) {
         case 0x1f488:  //💈
             return sizeof(std::thread*);
         case 0x1f510:  //🔐
-            return sizeof(pthread_mutex_t);
+        case 0x1f6a6:  //🚦
+        case 0x1f3ab:  //🎫
+        case 0x1f41c:  //🐜
+            return sizeof(Object *);
+        case 0x1f4ee:  //📮
+            return sizeof(Future);
+        case 0x1f522:  //🔢
+            return sizeof(std::atomic<EmojicodeInteger>);
+        case 0x1f6a1:  //🚡
+            return sizeof(ConcurrentQueue);
+        case 0x1f4e1:  //📡
+            return sizeof(Channel);
         case 0x1f3b0:
             return sizeof(std::mt19937_64);
     }
@@ -597,12 +983,34 @@ Marker markerPointerForClass(EmojicodeChar cl) {
             return listMark;
         case 0x1F36F:  // Dictionary
             return dictionaryMark;
+        case 0x1f4d2:  //📒
+        case 0x1f516:  //🔖
+            return primitiveKeyDictionaryMark;
+        case 0x1f52d:  //🔭
+            return dictionaryEnumeratorMark;
         case 0x1F521:
             return stringMark;
+        case 0x1f3d7:  //🏗
+            return stringBuilderMark;
+        case 0x1f4ca:  //📊
+        case 0x1f4c8:  //📈
+        case 0x1f4be:  //💾
+            return primitiveArrayMark;
         case 0x1F347:
             return closureMark;
         case 0x1F4C7:
             return dataMark;
+        case 0x1f510:  //🔐
+        case 0x1f6a6:  //🚦
+        case 0x1f3ab:  //🎫
+        case 0x1f41c:  //🐜
+            return pinnedValueMark;
+        case 0x1f4ee:  //📮
+            return futureMark;
+        case 0x1f6a1:  //🚡
+            return concurrentQueueMark;
+        case 0x1f4e1:  //📡
+            return channelMark;
     }
     return nullptr;
 }
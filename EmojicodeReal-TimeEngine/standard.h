@@ -16,7 +16,11 @@ namespace Emojicode {
 struct Data {
     EmojicodeInteger length;
     char *bytes;
+    /// The array or the pinned buffer (see @c newPinnedBuffer) that contains @c bytes.
     Object *bytesObject;
+
+    /// Returns true if @c bytes lie in a pinned buffer and therefore remain valid inside a @c BlockingRegion.
+    bool pinned() const { return bytesObject != nullptr && bytesObject->klass == CL_PINNED_BUFFER; }
 };
 
 }
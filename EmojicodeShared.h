@@ -21,7 +21,7 @@ typedef uint32_t EmojicodeInstruction;
 #define defaultPackagesDirectory "/usr/local/EmojicodePackages"
 #endif
 
-#define BYTE_CODE_VERSION 5
+#define BYTE_CODE_VERSION 6
 
 #define T_NOTHINGNESS 0
 #define T_OBJECT 1
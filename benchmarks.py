@@ -0,0 +1,42 @@
+from subprocess import *
+import os
+import dist
+import time
+
+benchmarks = [
+    "stringSearch",
+    "stringSplit",
+    "stringCase",
+    "stringUTF8",
+]
+string_kernels = ["scalar", "sse2", "avx2"]
+
+emojicode = os.path.abspath("emojicode")
+emojicodec = os.path.abspath("emojicodec")
+os.environ["EMOJICODE_PACKAGES_PATH"] = os.path.join(dist.path, "packages")
+
+
+def benchmark_paths(name):
+    return (os.path.join(dist.source, "tests", "benchmarks", name + ".emojic"),
+            os.path.join(dist.source, "tests", "benchmarks", name + ".emojib"))
+
+
+def benchmark(name):
+    source_path, binary_path = benchmark_paths(name)
+
+    run([emojicodec, source_path], check=True)
+    for kernels in string_kernels:
+        os.environ["EMOJICODE_STRING_KERNELS"] = kernels
+        start = time.perf_counter()
+        completed = run([emojicode, binary_path], stdout=PIPE, stderr=PIPE)
+        duration = time.perf_counter() - start
+        if completed.returncode != 0:
+            print("⏭  {0} ({1}) skipped".format(name, kernels))
+            continue
+        print("⏱  {0} ({1}): {2:.0f} ms".format(name, kernels,
+                                                 duration * 1000))
+    del os.environ["EMOJICODE_STRING_KERNELS"]
+
+
+for name in benchmarks:
+    benchmark(name)
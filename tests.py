@@ -2,6 +2,7 @@ from subprocess import *
 import glob
 import os
 import dist
+import platform
 import sys
 import re
 
@@ -63,15 +64,57 @@ compilation_tests = [
     "gcStressTest1",
     "gcStressTest2",
     "gcStressTest3",
+    "gcStressTest4",
+    "gcUnalignedSizes",
+    "gcDataSlice",
+    "gcClosures",
+    "gcCapturedVariables",
+    "gcThreadExit",
     "valueTypeCopySelf",
     "valueTypeBoxCopySelf",
     "includer",
     "threads",
+    "threadsSafepoint",
+    "threadsSafepointSpin",
+    "threadsSync",
+    "taskPool",
+    "atomics",
+    "channels",
+    "fibers",
+]
+mark_compact_tests = [
+    "gcStressTest1",
+    "gcStressTest2",
+    "gcStressTest3",
+    "gcStressTest4",
+    "gcUnalignedSizes",
+    "gcDataSlice",
+    "gcClosures",
+    "gcCapturedVariables",
+    "gcThreadedAllocation",
+    "gcThreadExit",
+    "threads",
+    "threadsSafepoint",
+    "threadsSafepointSpin",
+    "threadsSync",
+    "taskPool",
+    "atomics",
+    "channels",
+    "fibers",
 ]
 library_tests = [
     "stringTest", "primitives", "mathTest", "listTest", "rangeTest",
     "dataTest", "dictionaryTest", "systemTest", "jsonTest", "enumerator",
-    "fileTest"
+    "fileTest", "arrayTest"
+]
+# The library tests are run again with each of these string kernels, which are
+# otherwise not used on a CPU that supports AVX2.
+library_string_kernels = ["scalar"]
+if platform.machine() in ("x86_64", "AMD64"):
+    library_string_kernels.append("sse2")
+fatal_tests = [
+    "stackOverflow",
+    "fiberStackOverflow",
 ]
 reject_tests = glob.glob(os.path.join(dist.source, "tests", "reject",
                                       "*.emojic"))
@@ -82,6 +125,10 @@ emojicode = os.path.abspath("emojicode")
 emojicodec = os.path.abspath("emojicodec")
 os.environ["EMOJICODE_PACKAGES_PATH"] = os.path.join(dist.path, "packages")
 
+# Seconds after which a test program is considered hung, e.g. by a thread
+# that never reaches a safepoint.
+test_timeout = 120
+
 
 def fail_test(name):
     global failed_tests
@@ -94,13 +141,27 @@ def test_paths(name, kind):
             os.path.join(dist.source, "tests", kind, name + ".emojib"))
 
 
-def library_test(name):
+def run_test_program(name, binary_path, stderr=None):
+    try:
+        return run([emojicode, binary_path], stdout=PIPE, stderr=stderr,
+                   timeout=test_timeout)
+    except TimeoutExpired:
+        print("{0} did not finish within {1} seconds".format(name,
+                                                            test_timeout))
+        fail_test(name)
+        return None
+
+
+def library_test(name, variant=None):
     source_path, binary_path = test_paths(name, 's')
+    label = name if variant is None else "{0} ({1})".format(name, variant)
 
     run([emojicodec, source_path], check=True)
-    completed = run([emojicode, binary_path], stdout=PIPE)
+    completed = run_test_program(label, binary_path)
+    if completed is None:
+        return
     if completed.returncode != 0:
-        fail_test(name)
+        fail_test(label)
         print(completed.stdout.decode('utf-8'))
 
 
@@ -108,7 +169,9 @@ def compilation_test(name):
     source_path, binary_path = test_paths(name, 'compilation')
 
     run([emojicodec, source_path], check=True)
-    completed = run([emojicode, binary_path], stdout=PIPE)
+    completed = run_test_program(name, binary_path)
+    if completed is None:
+        return
     exp_path = os.path.join(dist.source, "tests", "compilation", name + ".txt")
     output = completed.stdout.decode('utf-8')
     if output != open(exp_path, "r", encoding='utf-8').read():
@@ -116,6 +179,21 @@ def compilation_test(name):
         fail_test(name)
 
 
+def fatal_test(name):
+    source_path, binary_path = test_paths(name, 'fatal')
+
+    run([emojicodec, source_path], check=True)
+    completed = run_test_program(name, binary_path, stderr=PIPE)
+    if completed is None:
+        return
+    exp_path = os.path.join(dist.source, "tests", "fatal", name + ".txt")
+    output = completed.stderr.decode('utf-8')
+    if (completed.returncode == 0 or
+            output != open(exp_path, "r", encoding='utf-8').read()):
+        print(output)
+        fail_test(name)
+
+
 def reject_test(filename):
     completed = run([emojicodec, filename], stderr=PIPE)
     output = completed.stderr.decode('utf-8')
@@ -126,11 +204,26 @@ def reject_test(filename):
 
 for test in compilation_tests:
     compilation_test(test)
+os.environ["EMOJICODE_COLLECTOR"] = "markcompact"
+for test in mark_compact_tests:
+    compilation_test(test)
+del os.environ["EMOJICODE_COLLECTOR"]
+for test in fatal_tests:
+    fatal_test(test)
 for test in reject_tests:
     reject_test(test)
 os.chdir(os.path.join(dist.source, "tests", "s"))
 for test in library_tests:
     library_test(test)
+os.environ["EMOJICODE_COLLECTOR"] = "markcompact"
+for test in library_tests:
+    library_test(test, "markcompact")
+del os.environ["EMOJICODE_COLLECTOR"]
+for kernels in library_string_kernels:
+    os.environ["EMOJICODE_STRING_KERNELS"] = kernels
+    for test in library_tests:
+        library_test(test, kernels)
+del os.environ["EMOJICODE_STRING_KERNELS"]
 
 if len(failed_tests) == 0:
     print("✅ ✅  All tests passed.")
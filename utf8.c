@@ -29,6 +29,10 @@
 #endif
 #include <assert.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "utf8.h"
 
 static const uint32_t offsetsFromUTF8[6] = {
@@ -70,13 +74,157 @@ size_t u8_charlen(uint32_t ch)
 
 size_t u8_codingsize(const uint32_t *wcstr, size_t n)
 {
-    size_t i, c=0;
-
-    for(i=0; i < n; i++)
+    size_t i=0, c=0;
+
+#if defined(__SSE2__)
+    /* every character takes one byte plus one for each of the limits
+       0x80, 0x800 and 0x10000 it reaches, and none beyond 0x10FFFF. the
+       comparisons are signed, so the characters are biased by 0x80000000. */
+    const __m128i bias = _mm_set1_epi32((int)0x80000000);
+    const __m128i two = _mm_set1_epi32((int)(0x7F ^ 0x80000000));
+    const __m128i three = _mm_set1_epi32((int)(0x7FF ^ 0x80000000));
+    const __m128i four = _mm_set1_epi32((int)(0xFFFF ^ 0x80000000));
+    const __m128i none = _mm_set1_epi32((int)(0x10FFFF ^ 0x80000000));
+    while (i + 4 <= n) {
+        /* the lanes count at most 4 extra bytes per block and must not
+           overflow */
+        size_t block_end = i + ((n - i) / 4 < (1 << 24) ? (n - i) / 4 : (1 << 24)) * 4;
+        __m128i extra = _mm_setzero_si128();
+        uint32_t lanes[4];
+        c += block_end - i;
+        for (; i < block_end; i += 4) {
+            __m128i ch = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(wcstr + i)), bias);
+            __m128i limits = _mm_add_epi32(_mm_add_epi32(_mm_cmpgt_epi32(ch, two), _mm_cmpgt_epi32(ch, three)),
+                                           _mm_cmpgt_epi32(ch, four));
+            limits = _mm_sub_epi32(limits, _mm_slli_epi32(_mm_cmpgt_epi32(ch, none), 2));
+            extra = _mm_sub_epi32(extra, limits);
+        }
+        _mm_storeu_si128((__m128i *)lanes, extra);
+        c += (size_t)((int32_t)lanes[0] + (int32_t)lanes[1] + (int32_t)lanes[2] + (int32_t)lanes[3]);
+    }
+#endif
+    for(; i < n; i++)
         c += u8_charlen(wcstr[i]);
     return c;
 }
 
+size_t u8_asciispan(const char *s, size_t sz)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 16 <= sz; i += 16) {
+        int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(s + i)));
+        if (mask != 0)
+            return i + __builtin_ctz(mask);
+    }
+#else
+    for (; i + 8 <= sz; i += 8) {
+        uint64_t word;
+        memcpy(&word, s + i, 8);
+        if (word & 0x8080808080808080ULL)
+            break;
+    }
+#endif
+    while (i < sz && (unsigned char)s[i] < 0x80)
+        i++;
+    return i;
+}
+
+size_t u8_measure(const char *s, size_t sz, unsigned char *maxbyte)
+{
+    size_t i = 0, count = 0;
+    unsigned char max = 0;
+
+#if defined(__SSE2__)
+    /* continuation bytes are the bytes from 0x80 to 0xBF, which are the
+       signed bytes not greater than 0xBF */
+    const __m128i last_continuation = _mm_set1_epi8((char)0xBF);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i vmax = zero;
+    unsigned char lanes[16];
+    int j;
+    while (i + 16 <= sz) {
+        /* the byte lanes count at most 255 characters each */
+        size_t block_end = i + ((sz - i) / 16 < 255 ? (sz - i) / 16 : 255) * 16;
+        __m128i characters = zero;
+        uint64_t sums[2];
+        for (; i < block_end; i += 16) {
+            __m128i bytes = _mm_loadu_si128((const __m128i *)(s + i));
+            vmax = _mm_max_epu8(vmax, bytes);
+            characters = _mm_sub_epi8(characters, _mm_cmpgt_epi8(bytes, last_continuation));
+        }
+        _mm_storeu_si128((__m128i *)sums, _mm_sad_epu8(characters, zero));
+        count += sums[0] + sums[1];
+    }
+    _mm_storeu_si128((__m128i *)lanes, vmax);
+    for (j = 0; j < 16; j++) {
+        if (lanes[j] > max)
+            max = lanes[j];
+    }
+#endif
+    for (; i < sz; i++) {
+        unsigned char byte = (unsigned char)s[i];
+        if (byte > max)
+            max = byte;
+        if (isutf(byte))
+            count++;
+    }
+    *maxbyte = max;
+    return count;
+}
+
+/* widens the ASCII characters at the start of src, but at most n, and
+   returns their number */
+static size_t u8_toucs_ascii(uint32_t *dest, const char *src, size_t n)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)(src + i));
+        if (_mm_movemask_epi8(bytes) != 0)
+            break;
+        __m128i low = _mm_unpacklo_epi8(bytes, zero);
+        __m128i high = _mm_unpackhi_epi8(bytes, zero);
+        _mm_storeu_si128((__m128i *)(dest + i), _mm_unpacklo_epi16(low, zero));
+        _mm_storeu_si128((__m128i *)(dest + i + 4), _mm_unpackhi_epi16(low, zero));
+        _mm_storeu_si128((__m128i *)(dest + i + 8), _mm_unpacklo_epi16(high, zero));
+        _mm_storeu_si128((__m128i *)(dest + i + 12), _mm_unpackhi_epi16(high, zero));
+    }
+#endif
+    for (; i < n && (unsigned char)src[i] < 0x80; i++)
+        dest[i] = (unsigned char)src[i];
+    return i;
+}
+
+/* narrows the ASCII characters at the start of src, but at most n, and
+   returns their number */
+static size_t u8_toutf8_ascii(char *dest, const uint32_t *src, size_t n)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i nonascii = _mm_set1_epi32(~0x7F);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + i + 4));
+        __m128i c = _mm_loadu_si128((const __m128i *)(src + i + 8));
+        __m128i d = _mm_loadu_si128((const __m128i *)(src + i + 12));
+        __m128i all = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(all, nonascii), zero)) != 0xFFFF)
+            break;
+        __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128((__m128i *)(dest + i), bytes);
+    }
+#endif
+    for (; i < n && src[i] < 0x80; i++)
+        dest[i] = (char)src[i];
+    return i;
+}
+
 /* conversions without error checking
    only works for valid UTF-8, i.e. no 5- or 6-byte sequences
    srcsz = source size in bytes
@@ -96,6 +244,11 @@ size_t u8_toucs(uint32_t *dest, size_t sz, const char *src, size_t srcsz)
         return 0;
 
     while (i < sz) {
+        nb = u8_toucs_ascii(dest + i, src, sz - i < (size_t)(src_end - src) ? sz - i : (size_t)(src_end - src));
+        i += nb;
+        src += nb;
+        if (i >= sz || src >= src_end)
+            break;
         if (!isutf(*src)) {     // invalid sequence
             dest[i++] = 0xFFFD;
             src++;
@@ -135,6 +288,11 @@ size_t u8_toutf8(char *dest, size_t sz, const uint32_t *src, size_t srcsz)
     char *dest_end = dest + sz;
 
     while (i < srcsz) {
+        size_t ascii = u8_toutf8_ascii(dest, src + i, srcsz - i < (size_t)(dest_end - dest) ? srcsz - i : (size_t)(dest_end - dest));
+        dest += ascii;
+        i += ascii;
+        if (i >= srcsz)
+            break;
         ch = src[i];
         if (ch < 0x80) {
             if (dest >= dest_end)
@@ -650,16 +808,16 @@ int u8_isvalid(const char *str, size_t length)
     size_t ab;
 
     for (p = (unsigned char*)str; p < pend; p++) {
+        p += u8_asciispan((const char *)p, pend - p);
+        if (p >= pend)
+            break;
         c = *p;
-        if (c < 128)
-            continue;
         ret = 2; /* non-ASCII UTF-8 */
         if ((c & 0xc0) != 0xc0)
             return 0;
         ab = trailingBytesForUTF8[c];
-        if (length < ab)
+        if ((size_t)(pend - p) <= ab)
             return 0;
-        length -= ab;
 
         p++;
         /* Check top bits in the second byte */
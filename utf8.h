@@ -52,6 +52,13 @@ size_t u8_charlen(uint32_t ch);
 /* computes the # of bytes needed to encode a WC string as UTF-8 */
 size_t u8_codingsize(const uint32_t *wcstr, size_t n);
 
+/* returns the # of bytes at the start of s that are ASCII */
+size_t u8_asciispan(const char *s, size_t sz);
+
+/* counts the characters in sz bytes of UTF-8 and stores the largest byte
+   in *maxbyte, both in a single pass */
+size_t u8_measure(const char *s, size_t sz, unsigned char *maxbyte);
+
 char read_escape_control_char(char c);
 
 /* assuming src points to the character after a backslash, read an